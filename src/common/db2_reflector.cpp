@@ -1,6 +1,22 @@
 #include "db2_reflector.h"
 
-db2DynArray<db2PackInfo *> db2PackInfo::pack_infos{};
-db2DynArray<db2Reflector *> db2Reflector::reflectors{};
+#include "containers/db2_cson.h"
+#include "data/db2_structure.h"
+
+constinit db2DynArray<db2PackInfo *> db2PackInfo::pack_infos{};
+constinit db2HashIndex db2PackInfo::pack_index{};
+
+constinit db2DynArray<db2Reflector *> db2Reflector::reflectors{};
+constinit db2HashIndex db2Reflector::index{};
+constinit db2HashIndex db2Reflector::info_index{};
+constinit bool db2Reflector::registered{false};
+
+auto db2Reflector::RegisterBuiltins() -> void
+{
+    db2Reflector::registered = true; // before reflecting, since Reflect() registers first
+
+    db2ChunkType_CSON::RegisterType();
+    db2ChunkType::RegisterType();
+}
 
 // int db2Reflector::caller = db2Reflector::LocalStaticTester();
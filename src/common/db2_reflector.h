@@ -2,12 +2,14 @@
 
 #include <cctype>             //std::toupper std::tolower
 #include <algorithm>          // std::equal
+#include <atomic>             // std::atomic
 #include <type_traits>        // std::is_same ...
 #include <typeinfo>           // std::typeinfo
 #include <boost/pfr/core.hpp> // reflect
 
 #include "db2_settings.h"
 #include "containers/db2_dynarray.h"
+#include "containers/db2_hash.h"
 
 // #include "stdio.h"
 
@@ -15,35 +17,38 @@ struct db2PackInfo
 {
 public: // static
     static db2DynArray<db2PackInfo *> pack_infos;
+    static db2HashIndex pack_index; // type -> index of pack_infos
 
     template <typename T>
     static auto Reflect_POD(const char *type) -> db2PackInfo *
     {
-        return db2PackInfo::pack_infos.push_back(new db2PackInfo())->reflect_pod<T>(type);
+        auto pack_info = db2PackInfo::pack_infos.push_back(new db2PackInfo());
+        pack_info->reflect_pod<T>(type);
+        db2PackInfo::pack_index.insert(db2HashIndex::Hash(reinterpret_cast<const int32_t &>(pack_info->type)), db2PackInfo::pack_infos.size() - 1);
+        return pack_info;
     }
 
     static auto ClearPackInfos() -> void
     {
         for (int i = 0; i < db2PackInfo::pack_infos.size(); ++i)
             delete db2PackInfo::pack_infos[i];
+        db2PackInfo::pack_infos.clear();
+        db2PackInfo::pack_index.clear();
     }
 
     static auto GetPackInfo(const char *type) -> db2PackInfo *
     {
-        for (int i = 0; i < db2PackInfo::pack_infos.size(); ++i)
-        {
-            auto &pack_info = db2PackInfo::pack_infos[i];
-            if (std::equal(type, type + 4, pack_info->type))
-                return pack_info;
-        }
-        return nullptr;
+        auto type_i = reinterpret_cast<const int32_t &>(*type);
+        auto i = db2PackInfo::pack_index.find(db2HashIndex::Hash(type_i), [&](uint32_t i)
+                                              { return reinterpret_cast<int32_t &>(db2PackInfo::pack_infos[i]->type) == type_i; });
+        return i != UINT32_MAX ? db2PackInfo::pack_infos[i] : nullptr;
     }
 
 public: // instance
     alignas(4) char type[4]{0, 0, 0, 0};
     uint8_t length{0};
-    db2DynArray<uint8_t> offsets{};
-    db2DynArray<uint8_t> lengths{};
+    db2DynArray<uint8_t, 16> offsets{}; // inline for structs of up to 16 fields
+    db2DynArray<uint8_t, 16> lengths{};
 
     template <typename T>
     auto reflect_pod(const char *type) -> void
@@ -76,6 +81,19 @@ public: // static
     // but it can still cause multiple instances across different libraries.
     // So, don't use inline static data menbers and forget about "header-only".
     static db2DynArray<db2Reflector *> reflectors;
+    static db2HashIndex index;      // type -> index of reflectors
+    static db2HashIndex info_index; // C++ type (see Hash) -> index of reflectors
+
+    // Built-in types (CSON and Box2D structures) are registered on the first access of the registry
+    // rather than by static initializers, so no lookup depends on static initialization order.
+    // The registry is constant-initialized, and the built-in types get the leading ids.
+    static bool registered;
+    static auto RegisterBuiltins() -> void; // defined in db2_reflector.cpp
+    static auto Register() -> void
+    {
+        if (!db2Reflector::registered)
+            db2Reflector::RegisterBuiltins();
+    }
 
     // // function-local static object in an inline function is also duplicated accross different libraries.
     // static int caller;
@@ -90,40 +108,62 @@ public: // static
     template <typename CK_T>
     static auto Reflect(const char *type) -> void
     {
-        db2Reflector::reflectors.push_back(new db2Reflector())->reflect<CK_T>(type);
+        db2Reflector::Register();
+
+        auto reflector = db2Reflector::reflectors.push_back(new db2Reflector());
+        reflector->reflect<CK_T>(type);
+        reflector->id = db2Reflector::reflectors.size() - 1;
+        db2Reflector::index.insert(db2HashIndex::Hash(reinterpret_cast<int32_t &>(reflector->type)), reflector->id);
+        db2Reflector::info_index.insert(db2Reflector::Hash(typeid(CK_T)), reflector->id);
     }
 
+    // Reflectors got before are dangling, and so are chunks reflected by them. The built-in types are
+    // registered again on the next access.
     static auto ClearReflectors() -> void
     {
         for (int i = 0; i < db2Reflector::reflectors.size(); ++i)
             delete db2Reflector::reflectors[i];
+        db2Reflector::reflectors.clear();
+        db2Reflector::index.clear();
+        db2Reflector::info_index.clear();
+        db2Reflector::registered = false;
+    }
+
+    static auto Hash(const std::type_info &info) -> uint32_t
+    {
+        auto hash = info.hash_code();
+        return db2HashIndex::Hash(int32_t(hash ^ (uint64_t(hash) >> 32)));
     }
 
     static auto GetReflector(const char *type) -> db2Reflector *
     {
-        for (int i = 0; i < db2Reflector::reflectors.size(); ++i)
-        {
-            auto &reflector = db2Reflector::reflectors[i];
-            if (std::equal(type, type + 4, reflector->type))
-                return reflector;
-        }
-        return nullptr;
+        db2Reflector::Register();
+
+        auto type_i = reinterpret_cast<const int32_t &>(*type);
+        auto i = db2Reflector::index.find(db2HashIndex::Hash(type_i), [&](uint32_t i)
+                                          { return reinterpret_cast<int32_t &>(db2Reflector::reflectors[i]->type) == type_i; });
+        return i != UINT32_MAX ? db2Reflector::reflectors[i] : nullptr;
     }
 
     template <typename CK_T>
-    static auto GetReflector() -> db2Reflector *
+    static auto GetReflector() -> db2Reflector * // null if CK_T is not registered
     {
-        static db2Reflector *Reflector = nullptr;
-        if (Reflector)
-            return Reflector;
-
-        for (int i = 0; i < db2Reflector::reflectors.size(); ++i)
-        {
-            auto &reflector = db2Reflector::reflectors[i];
-            if (reflector->info == &typeid(CK_T))
-                return Reflector = reflector, Reflector;
-        }
-        return nullptr;
+        auto match = [](uint32_t i) -> bool
+        { return *db2Reflector::reflectors[i]->info == typeid(CK_T); };
+
+        // the index is cached, and checked against the registry, which could have been cleared since
+        static std::atomic<uint32_t> cached{UINT32_MAX};
+        db2Reflector::Register();
+
+        auto i = cached.load(std::memory_order_relaxed);
+        if (i < db2Reflector::reflectors.size() && match(i))
+            return db2Reflector::reflectors[i];
+
+        i = db2Reflector::info_index.find(db2Reflector::Hash(typeid(CK_T)), match);
+        if (i == UINT32_MAX)
+            return nullptr;
+        cached.store(i, std::memory_order_relaxed);
+        return db2Reflector::reflectors[i];
     }
 
     template <typename CK_T>
@@ -135,7 +175,7 @@ public: // static
     template <typename CK_T>
     static auto IsRefOf(const char *type) -> bool
     {
-        static auto reflector = db2Reflector::GetReflector<CK_T>();
+        auto reflector = db2Reflector::GetReflector<CK_T>();
         return std::equal(type, type + 4, reflector->type_ref);
     }
 
@@ -143,12 +183,15 @@ public: // instance
     alignas(4) char type[4]{0, 0, 0, 0};
     DB2_DEPRECATED char type_ref[4]{0, 0, 0, 0};
 
+    bool is_chunk = false;    // a chunk type, whose values are linked by index, rather than a POD stored in place
     bool is_type_int = false; // int type is allowed for sub-chunks
     bool is_dynamic = false;  // dynamic nesting is allowed for sub-chunks
     const db2DynArray<int32_t> *end_types = nullptr;
 
     const std::type_info *info;
 
+    uint32_t id{UINT32_MAX}; // index in reflectors, only for top-level (registered) types
+
     db2PackInfo *prefix{nullptr};
 
 private:
@@ -203,6 +246,8 @@ public:
         }
         else // container
         {
+            this->is_chunk = true;
+
             // type_type
             if constexpr (has_type_type_v<CK_T>)
                 if constexpr (std::is_same_v<typename CK_T::type_type, int32_t>)
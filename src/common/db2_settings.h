@@ -18,6 +18,21 @@ using float64_t = double;
 #define DB2_PRAGMA_PACK_ON DB2_PRAGMA_PACK(DB2_PACK_SIZE) // _Pragma("pack(8)")
 #define DB2_PRAGMA_PACK_OFF DB2_PRAGMA_PACK()             // _Pragma("pack()")
 
+#define DB2_DYNARRAY_GROWTH_NUM 2 // growth factor of db2DynArray is NUM / DEN, 2 keeps capacities at powers of 2
+#define DB2_DYNARRAY_GROWTH_DEN 1
+
+#define DB2_CHUNK_ALIGNMENT 32  // byte, alignment of chunk payloads in memory, 0 for the malloc default
+#define DB2_TENSOR_ALIGNMENT 32 // byte, alignment of tensor data on the heap
+
+#define DB2_DICT_LOOKUP_THRESHOLD 8 // element count, from which an unsorted db2Layout is searched through a key table
+
+#define DB2_DECODE_THREADS 0  // threads building Box2D defs in db2Decoder::Decode, 0 for std::thread::hardware_concurrency()
+#define DB2_DECODE_BATCH 4096 // body count, from which another decoding thread is started
+#define DB2_DECODE_SLICE 64   // bodies created between budget checks of db2IncrementalDecoder
+
+#define DB2_FRAME_POSITION_STEP (1.0f / 1024.0f) // meter, resolution of quantized positions in frames (db2StateQ)
+#define DB2_FRAME_VELOCITY_STEP (1.0f / 256.0f)  // meter or radian per second, resolution of quantized velocities in frames
+
 #define DB2_NOTE(note)
 #define DB2_SEMICOLON ;
 #define DB2_ASSERT(assert) DB2_SEMICOLON static_assert(assert, #assert)
@@ -0,0 +1,76 @@
+#pragma once
+
+#include "db2_cson.h"
+
+/*
+db2Builder constructs CSON documents in bulk, where counts of values are known up front.
+Values are appended to their pools (see db2Dict::emplace_val) in blocks reserved at once, so their
+indices are known before any is written, and links are written without looking keys up.
+
+    auto first = builder.append<CKBody>(count); // pool grows once
+    ...
+    db2Builder::Link<CKBody>(dict, db2Key::Base, first + i);
+
+Links are written without recording them in an attached db2References, and finish() rebuilds it.
+*/
+
+class db2Builder
+{
+public:
+    db2Chunks &chunks;
+
+public:
+    db2Builder(db2Chunks &chunks) : chunks{chunks} {}
+
+    template <typename CK_T>
+    auto append(const uint32_t count) -> uint32_t // appends count values to the pool of CK_T, returns the index of the first
+    {
+        auto &pool = this->chunks.get<CK_T>();
+        auto first = pool.size();
+        if (count == 0)
+            return first;
+
+        pool.reserve(first + count, first > 0); // exact for a new pool, amortized for blocks after
+        if constexpr (has_flag_db2Chunk_v<typename CK_T::value_type>) // sub-chunks are initialized one by one
+            for (uint32_t i = 0; i < count; ++i)
+                pool.emplace_back();
+        else
+            pool.expand(first + count);
+        return first;
+    }
+
+    template <typename CK_T>
+    auto pool() -> CK_T & { return this->chunks.get<CK_T>(); }
+
+    auto finish() -> void
+    {
+        if (this->chunks.references)
+            this->chunks.references->build(this->chunks);
+    }
+
+public:
+    template <typename CK_T>
+    static auto Link(db2Dict &dict, const int32_t key, const uint32_t index) -> void // key should be new in dict
+    {
+        dict.append<CK_T>(key, index);
+    }
+
+    template <typename CK_T>
+    static auto Link(db2List &list, const uint32_t first, const uint32_t count) -> void // appends first, first + 1, ...
+    {
+        list.handle_type<CK_T>(true);
+        auto size = list.size();
+        list.expand(size + count, false);
+        for (uint32_t i = 0; i < count; ++i)
+            list[size + i] = first + i;
+    }
+
+    template <typename CK_T>
+    static auto Expand(db2List &list, const uint32_t count) -> uint32_t // appends count links to be written in any order, returns the first
+    {
+        list.handle_type<CK_T>(true);
+        auto size = list.size();
+        list.expand(size + count, false);
+        return size;
+    }
+};
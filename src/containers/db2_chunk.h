@@ -1,12 +1,14 @@
 #pragma once
 
 #include <fstream>
+#include <utility> // std::as_const
 
 #include <boost/crc.hpp> // crc
 
 #include "common/db2_hardware_difference.h"
 #include "common/db2_reflector.h"
 #include "db2_dynarray.h"
+#include "db2_hash.h"
 
 /*
 class db2Chunk is designed to process flat data structures for file storage.
@@ -27,6 +29,60 @@ class db2ChunkStruct;
 
 class db2Chunks;
 
+class db2References;
+
+/*
+db2ByteSource is what chunks are read from, a file stream or a memory buffer, so db2Chunk::read() is
+written once for both. It is bounded by the bytes remaining, and a read past them fails and reads
+nothing. A chunk narrows the bound to its own length while its sub-chunks are read.
+*/
+class db2ByteSource
+{
+public:
+    std::ifstream *fs{nullptr};   // nullptr for memory
+    const char *cursor{nullptr};  // memory only
+    uint64_t remaining{0};        // bytes left to read
+
+public:
+    db2ByteSource(std::ifstream &fs) : fs{&fs}
+    {
+        auto position = fs.tellg();
+        fs.seekg(0, std::ios::end);
+        this->remaining = fs.tellg() - position;
+        fs.seekg(position);
+    }
+
+    db2ByteSource(const char *cursor, const char *end) : cursor{cursor}, remaining{static_cast<uint64_t>(end - cursor)} {}
+
+    auto is_memory() const -> bool { return this->fs == nullptr; }
+
+    auto read(char *data, const uint32_t length) -> bool
+    {
+        if (length > this->remaining)
+            return false;
+
+        if (this->fs)
+            this->fs->read(data, length);
+        else
+            std::memcpy(data, this->cursor, length);
+        this->skip(length);
+        return true;
+    }
+
+    auto skip(const uint32_t length) -> void // past bytes consumed otherwise (see db2Chunk::read)
+    {
+        if (!this->fs)
+            this->cursor += length;
+        this->remaining -= length;
+    }
+};
+
+template <typename T> // payload storage of chunks
+using db2ChunkArray = db2DynArray<T, 0, DB2_CHUNK_ALIGNMENT>;
+
+template <typename T, typename T_pfx>
+using db2ChunkArrayWithPrefix = db2DynArrayWithPrefix<T, T_pfx, DB2_CHUNK_ALIGNMENT>;
+
 #define DB2_CHUNK_CONSTRUCTORS(CLS)                                                \
     CLS() = default;                                                               \
     CLS(const CLS &other) { this->copy(other); }                                   \
@@ -39,24 +95,32 @@ class db2Chunks;
     bool operator!=(const CLS &other) const = delete;
 
 template <trivialC_or_db2Chunk T, typename T_pfx>
-class db2Chunk : public db2DynArrayWithPrefix<T, T_pfx>
+class db2Chunk : public db2ChunkArrayWithPrefix<T, T_pfx>
 {
 public:
     using flag_db2Chunk = void;
 
 public:
-    TYPE_IRRELATIVE static auto ReadBytes(char *data, const uint32_t length, std::ifstream &fs, const bool reverseEndian, db2PackInfo *pack = nullptr, boost::crc_32_type *CRC = nullptr) -> void
+    TYPE_IRRELATIVE static auto ReadBytes(char *data, const uint32_t length, db2ByteSource &source, const bool reverseEndian, db2PackInfo *pack = nullptr, boost::crc_32_type *CRC = nullptr) -> bool // false if cut short
     {
         if (data == nullptr || length == 0)
-            return;
+            return true;
 
-        fs.read(data, length);
+        if (!source.read(data, length))
+            return false;
 
         if (CRC)
             CRC->process_bytes(data, length);
 
         if (reverseEndian)
             db2Chunk::ReverseEndian(data, length, pack);
+        return true;
+    }
+
+    TYPE_IRRELATIVE static auto IsAligned(const char *data) -> bool // as allocated payloads are, see db2ChunkArray
+    {
+        constexpr uintptr_t alignment = DB2_CHUNK_ALIGNMENT > 0 ? DB2_CHUNK_ALIGNMENT : alignof(std::max_align_t);
+        return reinterpret_cast<uintptr_t>(data) % alignment == 0;
     }
 
     TYPE_IRRELATIVE static auto WriteBytes(char *data, const uint32_t length, std::ofstream &fs, const bool reverseEndian, db2PackInfo *pack = nullptr, boost::crc_32_type *CRC = nullptr) -> void
@@ -112,7 +176,10 @@ public:
 
     void *runtime = nullptr;
 
+    db2HashIndex *lookup = nullptr; // lazily built side index (see db2Layout), owned, never stored in file
+
     int32_t &type_i() { return reinterpret_cast<int32_t &>(this->type); }
+    const int32_t &type_i() const { return reinterpret_cast<const int32_t &>(this->type); }
 
 public: // constructors and initiators
     TYPE_IRRELATIVE DB2_CHUNK_CONSTRUCTORS(db2Chunk);
@@ -133,6 +200,9 @@ public: // constructors and initiators
 
     TYPE_IRRELATIVE auto clear() -> void
     {
+        delete this->lookup;
+        this->lookup = nullptr;
+
         if (!this->data)
             return; // length should be 0
 
@@ -141,12 +211,12 @@ public: // constructors and initiators
         {
             // clear sub-chunks (only for reflected types)
             auto this_ = reinterpret_cast<db2Chunk<db2Chunk<char, char>, char> *>(this);
-            this_->db2DynArrayWithPrefix<db2Chunk<char, char>, char>::clear();
+            this_->db2ChunkArrayWithPrefix<db2Chunk<char, char>, char>::clear();
         }
         else
         {
             auto this_ = reinterpret_cast<db2Chunk<char, char> *>(this);
-            this_->db2DynArrayWithPrefix<char, char>::clear();
+            this_->db2ChunkArrayWithPrefix<char, char>::clear();
         }
 
         // clear derived data
@@ -174,6 +244,8 @@ public: // constructors and initiators
             this->reflector = other.reflector;
         this->root = other.root;
         this->runtime = nullptr;
+        delete this->lookup;
+        this->lookup = nullptr;
 
         // copy base
         if (this->reflector && this->reflector->get_child(this->type))
@@ -181,18 +253,76 @@ public: // constructors and initiators
             // copy sub-chunks (only for reflected types)
             auto &this_ = reinterpret_cast<db2Chunk<db2Chunk<char, char>, char> &>(*this);
             auto &other_ = reinterpret_cast<const db2Chunk<db2Chunk<char, char>, char> &>(other);
-            this_.db2DynArrayWithPrefix<db2Chunk<char, char>, char>::copy(other_);
+            this_.db2ChunkArrayWithPrefix<db2Chunk<char, char>, char>::copy(other_);
         }
         else
         {
             auto &this_ = reinterpret_cast<db2Chunk<char, char> &>(*this);
             auto &other_ = reinterpret_cast<const db2Chunk<char, char> &>(other);
-            this_.db2DynArrayWithPrefix<char, char>::copy(other_);
+            this_.db2ChunkArrayWithPrefix<char, char>::copy(other_);
+        }
+    }
+
+    TYPE_IRRELATIVE auto share(const db2Chunk &other, db2Chunks *root) -> void // copy-on-write copy (see db2Chunks::share)
+    {
+        this->clear();
+
+        this->length_chunk = other.length_chunk;
+        this->type_i() = other.type_i();
+        this->crc = other.crc;
+
+        this->reflector = other.reflector;
+        this->root = root;
+        this->runtime = nullptr;
+
+        // prefix is small, copy it
+        auto &this_c = reinterpret_cast<db2Chunk<char, char> &>(*this);
+        auto &other_c = reinterpret_cast<const db2Chunk<char, char> &>(other);
+        if (other_c.prefix)
+        {
+            this_c.reserve_pfx_mem(other_c.length_pfx);
+            std::memcpy(this_c.prefix, other_c.prefix, other_c.length_pfx);
+            this_c.length_pfx = other_c.length_pfx;
+        }
+
+        // share base
+        if (this->reflector && this->reflector->get_child(this->type))
+        {
+            // sub-chunks are not shared but shared recursively, since they refer to their root
+            auto &this_ = reinterpret_cast<db2Chunk<db2Chunk<char, char>, char> &>(*this);
+            auto &other_ = reinterpret_cast<const db2Chunk<db2Chunk<char, char>, char> &>(other);
+            this_.reserve(other_.size(), false);
+            for (uint32_t i = 0; i < other_.size(); ++i)
+                this_.db2ChunkArray<db2Chunk<char, char>>::emplace_back().share(other_[i], root);
+        }
+        else
+        {
+            this_c.db2ChunkArray<char>::share(other_c);
         }
     }
 
 public:
-    TYPE_IRRELATIVE auto read(std::ifstream &fs, const bool isLittleEndian, boost::crc_32_type *CRC = nullptr) -> void
+    TYPE_IRRELATIVE auto read(std::ifstream &fs, const bool isLittleEndian) -> bool // false if the chunk is malformed or cut short
+    {
+        db2ByteSource source{fs};
+        return this->read(source, isLittleEndian);
+    }
+
+    /*
+    Reads a chunk from memory, at cursor, which is advanced past the chunk. Payloads of the local
+    endian borrow the memory rather than being copied (see db2DynArray::view), when they are aligned
+    as allocated payloads are (DB2_CHUNK_ALIGNMENT), so bytes should outlive the chunk or its
+    modifying. Other payloads and prefixes are copied into aligned storage.
+    */
+    TYPE_IRRELATIVE auto read(const char *&cursor, const char *end, const bool isLittleEndian) -> bool // false if the chunk is malformed or overruns end
+    {
+        db2ByteSource source{cursor, end};
+        auto result = this->read(source, isLittleEndian);
+        cursor = source.cursor;
+        return result;
+    }
+
+    TYPE_IRRELATIVE auto read(db2ByteSource &source, const bool isLittleEndian, boost::crc_32_type *CRC = nullptr) -> bool
     {
         assert(this->length == 0);
 
@@ -204,52 +334,75 @@ public:
         const bool reverseEndian_data = HardwareDifference::IsLittleEndian() != isLittleEndian;
 
         // length
-        db2Chunk::ReadBytes((char *)&this->length_chunk, sizeof(this->length_chunk), fs, reverseEndian, nullptr, CRC);
+        if (!db2Chunk::ReadBytes((char *)&this->length_chunk, sizeof(this->length_chunk), source, reverseEndian, nullptr, CRC))
+            return false;
 
         // CRC
+        boost::crc_32_type CRC_chunk{};
         if (CRC == nullptr)
-            CRC = new boost::crc_32_type{};
+            CRC = &CRC_chunk;
 
         // type
-        db2Chunk::ReadBytes(this->type, sizeof(this->type), fs, reverseEndian_type, nullptr, CRC); // overwrite type with data from file
+        if (!db2Chunk::ReadBytes(this->type, sizeof(this->type), source, reverseEndian_type, nullptr, CRC)) // overwrite type with data from file
+            return false;
         if (this->reflector == nullptr)
             this->reflector = db2Reflector::GetReflector(this->type);
+        if (this->reflector == nullptr)
+            return false; // unknown type
 
         // prefix
         if (this->reflector->prefix)
         {
+            if (this->reflector->prefix->length > this->length_chunk)
+                return false;
             this->length_pfx = this->reflector->prefix->length;
             this->reserve_pfx_mem(this->length_pfx);
-            db2Chunk::ReadBytes((char *)this->prefix, this->length_pfx, fs, reverseEndian_data, this->reflector->prefix, CRC);
+            if (!db2Chunk::ReadBytes((char *)this->prefix, this->length_pfx, source, reverseEndian_data, this->reflector->prefix, CRC))
+                return false;
         }
 
         // data
+        auto length = this->length_chunk - this->length_pfx;
+        if (length > source.remaining)
+            return false;
+
         if (this->reflector->get_child(this->type) == nullptr)
         {
-            this->length = this->length_chunk - this->length_pfx;
-            this->reserve_mem(this->length, false);
-            db2Chunk::ReadBytes((char *)this->data, this->length, fs, reverseEndian_data, this->reflector->get_value(this->type), CRC);
+            auto pack = this->reflector->get_value(this->type);
+            if (source.is_memory() && !reverseEndian_data && db2Chunk::IsAligned(source.cursor))
+            {
+                CRC->process_bytes(source.cursor, length);
+                reinterpret_cast<db2Chunk<char, char> *>(this)->db2ChunkArray<char>::view(source.cursor, length);
+                source.skip(length);
+            }
+            else
+            {
+                this->length = length;
+                this->reserve_mem(this->length, false);
+                db2Chunk::ReadBytes((char *)this->data, this->length, source, reverseEndian_data, pack, CRC);
+            }
         }
         else
         {
-            auto p0 = fs.tellg();
-            auto pn = p0;
-            while (pn - p0 < this->length_chunk - this->length_pfx)
+            auto rest = source.remaining - length; // sub-chunks are bounded by this chunk
+            source.remaining = length;
+            while (source.remaining > 0)
             {
                 auto &child = ((db2Chunk<db2Chunk<char>> *)this)->emplace_back();
-                child.read(fs, isLittleEndian, CRC); // recursion
-                pn = fs.tellg();
+                if (!child.read(source, isLittleEndian, CRC)) // recursion
+                    return false;
             }
-            assert(pn - p0 == this->length_chunk - this->length_pfx);
+            source.remaining = rest;
         }
 
         // CRC
         if (this->reflector->parent == nullptr)
         {
-            db2Chunk::ReadBytes((char *)&(this->crc), sizeof(this->crc), fs, reverseEndian, nullptr, nullptr);
+            if (!db2Chunk::ReadBytes((char *)&(this->crc), sizeof(this->crc), source, reverseEndian, nullptr, nullptr))
+                return false;
             assert(CRC->checksum() == this->crc);
-            delete CRC;
         }
+        return true;
     }
 
     TYPE_IRRELATIVE auto write(std::ofstream &fs, const bool asLittleEndian, boost::crc_32_type *CRC = nullptr) -> void
@@ -325,7 +478,7 @@ public:
     {
         if constexpr (has_flag_db2Chunk_v<T>) // sub-chunk
         {
-            auto &element = this->db2DynArray<T>::emplace(index);
+            auto &element = this->db2ChunkArray<T>::emplace(index);
             // element.pre_init(this->reflector->get_child(this->type), this->root);
             reinterpret_cast<db2Chunk<char, char> &>(element).pre_init(this->reflector->get_child(this->type), this->root);
             element.init(std::forward<Args>(args)...);
@@ -333,7 +486,7 @@ public:
         }
         else
         {
-            return this->db2DynArray<T>::emplace(index, std::forward<Args>(args)...);
+            return this->db2ChunkArray<T>::emplace(index, std::forward<Args>(args)...);
         }
     }
 
@@ -342,7 +495,7 @@ public:
     {
         if constexpr (has_flag_db2Chunk_v<T>) // sub-chunk
         {
-            auto &element = this->db2DynArray<T>::emplace_back();
+            auto &element = this->db2ChunkArray<T>::emplace_back();
             // element.pre_init(this->reflector->get_child(this->type), this->root);
             reinterpret_cast<db2Chunk<char, char> &>(element).pre_init(this->reflector->get_child(this->type), this->root);
             element.init(std::forward<Args>(args)...);
@@ -350,7 +503,7 @@ public:
         }
         else
         {
-            return this->db2DynArray<T>::emplace_back(std::forward<Args>(args)...);
+            return this->db2ChunkArray<T>::emplace_back(std::forward<Args>(args)...);
         }
     }
 
@@ -368,24 +521,46 @@ public:
 class db2Chunks : public db2DynArray<db2Chunk<char> *>
 {
 public:
-    ~db2Chunks()
-    {
-        for (auto i = 0; i < this->size(); ++i)
-            delete this->data[i];
-    }
+    db2References *references{nullptr}; // optional reverse-reference index, not owned (see db2References)
+
+public:
+    ~db2Chunks(); // detaches the attached db2References, see db2_references.cpp
 
 public:
     auto operator[](const uint32_t index) const -> db2Chunk<char> & { return *this->db2DynArray<db2Chunk<char> *>::operator[](index); }
 
+    template <typename CK_T>
+    auto at() -> CK_T &
+    {
+        auto &chunk = this->at(db2Reflector::GetReflector<CK_T>());
+        return reinterpret_cast<CK_T &>(chunk);
+    }
+
     template <typename CK_T>
     auto at() const -> CK_T &
     {
-        for (auto i = 0; i < this->size(); ++i)
-        {
-            auto p_chunk = this->data[i];
-            if (p_chunk->reflector->info == &typeid(CK_T))
-                return *(CK_T *)p_chunk;
-        }
+        auto &chunk = this->at(db2Reflector::GetReflector<CK_T>());
+        return reinterpret_cast<CK_T &>(chunk);
+    }
+
+    auto at(const db2Reflector *reflector) -> db2Chunk<char> & // the first chunk of reflector, type-irrelative
+    {
+        this->sync_slots();
+        return std::as_const(*this).at(reflector);
+    }
+
+    auto at(const db2Reflector *reflector) const -> db2Chunk<char> & // as at(), without indexing new chunks, so safe to call across threads
+    {
+        if (!reflector)
+            return nullval;
+
+        auto id = reflector->id;
+        if (id < this->slots.size() && this->slots[id] != UINT32_MAX)
+            return *this->data[this->slots[id]];
+
+        for (auto i = this->indexed; i < this->size(); ++i) // not indexed yet
+            if (this->data[i]->reflector == reflector)
+                return *this->data[i];
         return nullval;
     }
 
@@ -401,8 +576,71 @@ public:
     {
         auto p_chunk = this->db2DynArray<db2Chunk<char> *>::emplace_back<default_type *>(new default_type());
         p_chunk->pre_init(db2Reflector::GetReflector<CK_T>(), this);
+        this->sync_slots();
         return *p_chunk;
     }
 
+public: // slots
+    /*
+    The slot table maps a reflector id to the index of the first chunk of that type, so at<CK_T>()
+    is a single indexed load. Chunks are indexed in order, and indexing pauses at a chunk whose
+    reflector is not known yet (e.g. emplaced as void and not read yet), and the rest is scanned
+    until then. Removing or reordering chunks requires reset_slots().
+    */
+    auto is_synced() const -> bool { return this->indexed == this->size(); } // every chunk indexed
+
+    auto reset_slots() -> void
+    {
+        this->slots.clear();
+        this->indexed = 0;
+    }
+
+    auto sync_slots() -> void
+    {
+        for (; this->indexed < this->size(); ++this->indexed)
+        {
+            auto reflector = this->data[this->indexed]->reflector;
+            if (!reflector)
+                return;
+            if (reflector->id == UINT32_MAX)
+                continue;
+
+            if (reflector->id >= this->slots.size())
+            {
+                auto size = this->slots.size();
+                this->slots.expand(reflector->id + 1, false);
+                for (auto i = size; i < this->slots.size(); ++i)
+                    this->slots[i] = UINT32_MAX;
+            }
+            if (this->slots[reflector->id] == UINT32_MAX)
+                this->slots[reflector->id] = this->indexed;
+        }
+    }
+
+private:
+    db2DynArray<uint32_t> slots{}; // reflector id -> chunk index
+    uint32_t indexed{0};           // chunks indexed into slots
+
+public:
+    auto share(const db2Chunks &other) -> void // fork other in O(number of chunks), payloads are copied once modified
+    {
+        for (auto i = 0; i < this->size(); ++i)
+            delete this->data[i];
+        this->db2DynArray<db2Chunk<char> *>::clear();
+        this->reset_slots();
+
+        this->reserve(other.size(), false);
+        for (auto i = 0; i < other.size(); ++i)
+            this->db2DynArray<db2Chunk<char> *>::emplace_back(new db2Chunk<char>())->share(other[i], this);
+        this->sync_slots();
+    }
+
+    auto pop_back() -> void // delete the last chunk
+    {
+        delete this->data[this->size() - 1];
+        this->db2DynArray<db2Chunk<char> *>::pop_back();
+        this->reset_slots();
+    }
+
     db2Chunk<char> *&push_back(const db2Chunk<char> *&t) = delete;
 };
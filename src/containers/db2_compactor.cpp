@@ -0,0 +1,189 @@
+#include "db2_compactor.h"
+
+auto db2Compactor::Compact(db2Chunks &chunks, const std::span<const uint32_t> roots) -> Remap
+{
+    Remap remap{};
+    remap.init(db2Reflector::reflectors.size());
+
+    // pools, every value is dropped until marked
+    for (uint32_t i = 0; i < chunks.size(); ++i)
+    {
+        auto &pool = chunks[i];
+        if (!pool.reflector || pool.reflector->id == UINT32_MAX || &chunks.at(pool.reflector) != &pool)
+            continue;
+
+        auto &pool_remap = remap[pool.reflector->id];
+        pool_remap.init(db2Compactor::Count(pool), false);
+        for (uint32_t j = 0; j < pool_remap.size(); ++j)
+            pool_remap[j] = UINT32_MAX;
+    }
+
+    // mark
+    auto dict_reflector = db2Reflector::GetReflector<CKDict>();
+    auto list_reflector = db2Reflector::GetReflector<CKList>();
+    auto layout_reflector = db2Reflector::GetReflector<CKLayout>();
+
+    db2DynArray<Item> items{};
+    for (auto root : roots)
+        db2Compactor::Mark(remap, items, dict_reflector, root);
+
+    while (items.size() > 0)
+    {
+        auto item = items.back();
+        items.pop_back();
+
+        if (item.id == dict_reflector->id)
+        {
+            auto &dict = chunks.at<CKDict>()[item.index];
+            auto &layout = dict.layout();
+            db2Compactor::Mark(remap, items, layout_reflector, dict.layout_i()); // layouts are kept while a dict uses them
+            for (uint32_t e = 0; e < dict.size(); ++e)
+                db2Compactor::Mark(remap, items, db2Reflector::GetReflector(&layout[e].type0), dict[e]);
+        }
+        else if (item.id == list_reflector->id)
+        {
+            auto &list = chunks.at<CKList>()[item.index];
+            auto reflector = db2Reflector::GetReflector(list.type);
+            for (uint32_t v = 0; v < list.size(); ++v)
+                db2Compactor::Mark(remap, items, reflector, list[v]);
+        }
+    }
+
+    // relocate
+    for (uint32_t i = 0; i < chunks.size(); ++i)
+    {
+        auto &pool = chunks[i];
+        if (pool.reflector && pool.reflector->id < remap.size() && &chunks.at(pool.reflector) == &pool)
+            db2Compactor::Relocate(pool, remap[pool.reflector->id]);
+    }
+
+    auto &layouts = chunks.at<CKLayout>();
+    if (layouts != nullval)
+        delete layouts.lookup, layouts.lookup = nullptr; // interned by old indices
+
+    // rewrite
+    auto &dicts = chunks.at<CKDict>();
+    for (uint32_t d = 0; dicts != nullval && d < dicts.size(); ++d)
+    {
+        auto &dict = dicts[d];
+        dict.layout_i() = db2Compactor::Rewrite(chunks, remap, layout_reflector, dict.layout_i()); // first, for the layout is read below
+        auto &layout = dict.layout();
+        for (uint32_t e = 0; e < dict.size(); ++e)
+        {
+            auto index = db2Compactor::Rewrite(chunks, remap, db2Reflector::GetReflector(&layout[e].type0), dict[e]);
+            if (index != dict[e])
+                dict.detach(), dict[e] = index;
+        }
+    }
+
+    auto &lists = chunks.at<CKList>();
+    for (uint32_t l = 0; lists != nullval && l < lists.size(); ++l)
+    {
+        auto &list = lists[l];
+        auto reflector = db2Reflector::GetReflector(list.type);
+        for (uint32_t v = 0; v < list.size(); ++v)
+        {
+            auto index = db2Compactor::Rewrite(chunks, remap, reflector, list[v]);
+            if (index != list[v])
+                list.detach(), list[v] = index;
+        }
+    }
+
+    if (chunks.references)
+        chunks.references->build(chunks);
+
+    return remap;
+}
+
+auto db2Compactor::CompactLayouts(db2Chunks &chunks) -> void
+{
+    auto &layouts = chunks.at<CKLayout>();
+    auto &dicts = chunks.at<CKDict>();
+    if (layouts == nullval)
+        return;
+
+    auto layout_reflector = db2Reflector::GetReflector<CKLayout>();
+    Remap remap{};
+    remap.init(db2Reflector::reflectors.size());
+    auto &layout_remap = remap[layout_reflector->id];
+    layout_remap.init(layouts.size(), false);
+    for (uint32_t i = 0; i < layout_remap.size(); ++i)
+        layout_remap[i] = UINT32_MAX;
+
+    for (uint32_t d = 0; dicts != nullval && d < dicts.size(); ++d)
+        if (dicts[d].layout_i() < layout_remap.size())
+            layout_remap[dicts[d].layout_i()] = 0;
+
+    db2Compactor::Relocate(reinterpret_cast<db2Chunk<char> &>(layouts), layout_remap);
+    delete layouts.lookup, layouts.lookup = nullptr; // interned by old indices
+
+    for (uint32_t d = 0; dicts != nullval && d < dicts.size(); ++d)
+        dicts[d].layout_i() = db2Compactor::Rewrite(chunks, remap, layout_reflector, dicts[d].layout_i());
+}
+
+auto db2Compactor::Count(db2Chunk<char> &pool) -> uint32_t // values of a pool, type-irrelative
+{
+    if (pool.reflector->get_child(pool.type))
+        return pool.length / sizeof(db2Chunk<char, char>);
+
+    auto pack = pool.reflector->get_value(pool.type);
+    return pack ? pool.length / pack->length : pool.length;
+}
+
+auto db2Compactor::Mark(Remap &remap, db2DynArray<Item> &items, const db2Reflector *reflector, const uint32_t index) -> void
+{
+    if (!reflector || !reflector->is_chunk || reflector->id >= remap.size())
+        return; // value in place
+
+    auto &pool_remap = remap[reflector->id]; // empty if not a pool
+    if (index >= pool_remap.size() || pool_remap[index] != UINT32_MAX)
+        return; // not a pool, out of bounds, or marked
+
+    pool_remap[index] = 0;
+    items.push_back(Item{reflector->id, index});
+}
+
+auto db2Compactor::Relocate(db2Chunk<char> &pool, db2DynArray<uint32_t> &pool_remap) -> void
+{
+    uint32_t count = 0;
+    for (uint32_t i = 0; i < pool_remap.size(); ++i)
+        if (pool_remap[i] != UINT32_MAX)
+            pool_remap[i] = count++;
+    if (count == pool_remap.size())
+        return; // nothing dropped
+
+    if (pool.reflector->get_child(pool.type))
+    {
+        // sub-chunks are relocated bitwise, as db2DynArray does when growing
+        auto &self = reinterpret_cast<db2Chunk<db2Chunk<char, char>, char> &>(pool);
+        for (uint32_t i = 0; i < pool_remap.size(); ++i)
+        {
+            if (pool_remap[i] == UINT32_MAX)
+                self[i].clear();
+            else if (pool_remap[i] != i)
+                std::memcpy((void *)&self[pool_remap[i]], (void *)&self[i], sizeof(db2Chunk<char, char>));
+        }
+        self.length = count * sizeof(db2Chunk<char, char>);
+    }
+    else
+    {
+        auto &self = reinterpret_cast<db2Chunk<char, char> &>(pool);
+        auto stride = self.length / pool_remap.size();
+        self.db2ChunkArray<char>::detach();
+        for (uint32_t i = 0; i < pool_remap.size(); ++i)
+            if (pool_remap[i] != UINT32_MAX && pool_remap[i] != i)
+                std::memmove(self.data + pool_remap[i] * stride, self.data + i * stride, stride);
+        self.length = count * stride;
+    }
+}
+
+auto db2Compactor::Rewrite(db2Chunks &chunks, const Remap &remap, const db2Reflector *reflector, const uint32_t index) -> uint32_t
+{
+    if (!reflector || !reflector->is_chunk || reflector->id >= remap.size())
+        return index; // value in place
+    if (chunks.at(reflector) == nullval)
+        return index; // link to a missing pool, left as it is
+
+    auto &pool_remap = remap[reflector->id];
+    return index < pool_remap.size() ? pool_remap[index] : UINT32_MAX;
+}
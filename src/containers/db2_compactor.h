@@ -0,0 +1,44 @@
+#pragma once
+
+#include <span>
+
+#include "db2_cson.h"
+
+/*
+Values of dicts and lists live in pools, the top-level chunks of their types (see db2Dict::emplace_val),
+and replaced or dropped values are never removed from them. db2Compactor collects them.
+
+Compact() marks every value reachable from the root dicts, through dict elements and list items
+of pool types, moves the survivors of each pool to its front in their original order, and rewrites
+the indices held by the surviving dicts and lists. Indices out of the bounds of their pools become
+null. A pool is the first top-level chunk of a type (as db2Chunks::at<CK_T>() finds), and other
+chunks are left untouched.
+
+The returned remap maps old indices of each pool (by reflector id) to new ones, or UINT32_MAX if
+dropped, for indices held outside of the chunks (e.g. userData of Box2D objects).
+
+CompactLayouts() drops only the layouts no dict uses, which sorting dicts or building them one key
+at a time leaves behind (see db2Layout), and renumbers the layouts of the dicts. Caches of layout
+indices (db2DictSlot, db2Schema) are stale afterwards, so it is meant for a fork that is written.
+*/
+
+class db2Compactor
+{
+public:
+    using Remap = db2DynArray<db2DynArray<uint32_t>>; // [reflector id][old index] -> new index
+
+    static auto Compact(db2Chunks &chunks, const std::span<const uint32_t> roots) -> Remap; // roots: indices of dicts
+    static auto CompactLayouts(db2Chunks &chunks) -> void;
+
+private:
+    struct Item
+    {
+        uint32_t id;
+        uint32_t index;
+    };
+
+    static auto Count(db2Chunk<char> &pool) -> uint32_t;
+    static auto Mark(Remap &remap, db2DynArray<Item> &items, const db2Reflector *reflector, const uint32_t index) -> void;
+    static auto Relocate(db2Chunk<char> &pool, db2DynArray<uint32_t> &pool_remap) -> void;
+    static auto Rewrite(db2Chunks &chunks, const Remap &remap, const db2Reflector *reflector, const uint32_t index) -> uint32_t;
+};
@@ -1,6 +1,98 @@
 #include "db2_cson.h"
 
-bool db2ChunkType_CSON::IsRegistered = db2ChunkType_CSON::RegisterType();
+auto db2Layout::Intern(db2Chunks &root, const db2DictElement *elements, const uint32_t count) -> uint32_t
+{
+    auto &layouts = root.get<CKLayout>();
+    auto match = [&](uint32_t i) -> bool
+    {
+        return layouts[i].size() == count && std::memcmp(layouts[i].data, elements, count * sizeof(db2DictElement)) == 0;
+    };
+
+    if (!layouts.lookup) // sequence hash -> layout, over the layouts loaded or added so far
+    {
+        layouts.lookup = new db2HashIndex{};
+        layouts.lookup->reserve(layouts.size());
+        for (uint32_t i = 0; i < layouts.size(); ++i)
+            layouts.lookup->insert(db2Layout::Hash(layouts[i].data, layouts[i].size()), i);
+    }
+
+    auto hash = db2Layout::Hash(elements, count);
+    auto index = layouts.lookup->find(hash, match);
+    if (index != UINT32_MAX)
+        return index;
+
+    auto sorted = true;
+    for (uint32_t i = 1; i < count && sorted; ++i)
+        sorted = !db2Layout::Less(elements[i], elements[i - 1].key, &elements[i - 1].type0);
+
+    index = layouts.size();
+    assert(index < db2Dict::Legacy);
+    auto &layout = layouts.emplace_back();
+    layout.append_span({elements, count});
+    layout.type[3] = sorted ? std::tolower(layout.type[3]) : std::toupper(layout.type[3]);
+
+    layouts.lookup->insert(hash, index);
+    return index;
+}
+
+auto db2Layout::Intern(db2Chunks &root, const uint32_t base, const db2DictElement &element) -> uint32_t
+{
+    db2DynArray<db2DictElement, 16> elements{};
+    if (base != db2Layout::Empty)
+    {
+        auto &layout = root.at<CKLayout>()[base];
+        elements.append_span({layout.data, layout.size()});
+    }
+    elements.emplace_back(element);
+    return db2Layout::Intern(root, elements.data, elements.size());
+}
+
+auto db2Layout::Sync(db2Chunks &root) -> void
+{
+    auto &layouts = root.at<CKLayout>(); // indexes the chunks of root too
+    if (layouts == nullval)
+        return;
+
+    for (uint32_t i = 0; i < layouts.size(); ++i)
+        if (!layouts[i].is_sorted() && layouts[i].size() >= DB2_DICT_LOOKUP_THRESHOLD)
+            layouts[i].sync_lookup();
+}
+
+auto db2Dict::Upgrade(db2Chunks &root, const bool reverseEndian) -> void
+{
+    auto &legacy = root.at<CKDict>();
+    auto is_legacy = [](db2Dict &dict) -> bool
+    { return dict.layout_i() == db2Dict::Legacy; };
+    if (legacy == nullval || legacy.find_index(is_legacy) == UINT32_MAX)
+        return;
+    root.get<CKLayout>(); // before referencing the dicts, for interning could add the chunk
+
+    auto &dicts = root.at<CKDict>();
+    db2DynArray<db2DictElement, 16> elements{};
+    db2DynArray<uint32_t, 16> values{};
+    for (uint32_t d = 0; d < dicts.size(); ++d)
+    {
+        auto &dict = dicts[d];
+        if (!is_legacy(dict))
+            continue;
+
+        // read as values, each of the 3 words of an element was reversed as a whole
+        auto n = dict.size() / 3;
+        elements.clear(), values.clear();
+        for (uint32_t i = 0; i < n; ++i)
+        {
+            auto &element = elements.emplace_back(db2DictElement{int32_t(dict.data[3 * i])});
+            std::memcpy(&element.type0, &dict.data[3 * i + 1], 4);
+            if (reverseEndian)
+                HardwareDifference::ReverseEndian(&element.type0, 4);
+            values.emplace_back(dict.data[3 * i + 2]);
+        }
+
+        dict.shrink(0);
+        dict.append_span({values.data, values.size()});
+        dict.layout_i() = n > 0 ? db2Layout::Intern(root, elements.data, n) : db2Layout::Empty;
+    }
+}
 
 auto db2ChunkType_CSON::RegisterType() -> bool
 {
@@ -8,6 +100,7 @@ auto db2ChunkType_CSON::RegisterType() -> bool
     db2Reflector::Reflect<float32_t>(db2ChunkType_CSON::PODF);
 
     db2Reflector::Reflect<CKDict>(db2ChunkType_CSON::DIcT);
+    db2Reflector::Reflect<CKLayout>(db2ChunkType_CSON::LAyt);
     db2Reflector::Reflect<CKList>(db2ChunkType_CSON::LIsT);
     db2Reflector::Reflect<CKString>(db2ChunkType_CSON::STrG);
 
@@ -16,4 +109,4 @@ auto db2ChunkType_CSON::RegisterType() -> bool
     // db2Reflector::Reflect<db2Chunk<db2String>>(db2ChunkType_CPPON::sTrG);
 
     return true;
-}
\ No newline at end of file
+}
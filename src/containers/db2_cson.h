@@ -1,6 +1,11 @@
 #pragma once
 
+#include <cctype>    // std::islower std::tolower std::toupper
+#include <algorithm> // std::stable_sort
+
 #include "db2_chunk.h"
+#include "db2_hash.h"
+#include "db2_references.h"
 
 /*
 CSON（C/C++ Structured Object Notation) is a JSON-like but binary data format.
@@ -9,136 +14,360 @@ Know issue: Due to the memory shifting issue brought by the base db2DynArray, re
 of chunk data could become invalid after new data is added to the same chunk. When editting
 CSON, referencing to the chunk data should be cautious. Use index or key to access the data
 when nessary.
+
+Chunks of a forked db2Chunks share their data (copy-on-write), and chunks parsed from memory borrow
+it (see db2DynArray::view). Modifiers (link, get, emplace...) and ref() detach the data first, but
+values reached by at(), find() or operator[] should be detach()ed before writing.
 */
 
 DB2_PRAGMA_PACK_ON
 
-struct db2DictElement
+struct db2DictElement // a key of a dict layout, whose value is stored by the dict
 {
     int32_t key{0};
 
     // the type of value, could be used to identify which chunk the value links to.
     char type0{0}, type1{0}, type2{0}, type3{0};
 
-    uint32_t value{UINT32_MAX};
-
-} DB2_NOTE(sizeof(db2DictElement) == 12);
+} DB2_NOTE(sizeof(db2DictElement) == 8);
 static_assert(std::is_trivially_copyable_v<db2DictElement>);
 
-struct db2Dict : public db2Chunk<db2DictElement>
+DB2_PRAGMA_PACK_OFF
+
+/*
+Dicts of the same (key, type) sequence share one db2Layout, like hidden classes of JS engines,
+and store only their values, in the order of the layout. Layouts are the sub-chunks of the LAyt
+chunk of the same root, and a dict refers to its layout by index, through the int type of its
+sub-chunk (db2Layout::Empty while it has no element).
+Layouts are interned by their sequences, so adding a key moves a dict to the layout of its new
+sequence, which is found or added. Layouts are never edited or removed once added, so a dict built
+one key at a time leaves a layout for each of its prefixes, shared by every dict of that prefix.
+A layout whose elements are ordered by (key, type) is marked by the lowercase 4th letter of its
+sub-chunk type ("LAYt"), and is searched by binary search. Other layouts of
+DB2_DICT_LOOKUP_THRESHOLD elements or more are searched through a key table, built on the first
+search. Key tables and the interning index are built lazily, but a const layout is searched
+without building them (it scans instead), so reading is safe across threads, and Sync() a root
+before that for speed.
+*/
+
+struct db2Layout : public db2Chunk<db2DictElement>
 {
+public: // static
+    static constexpr uint32_t Empty = UINT32_MAX;
+
+    static auto Hash(const db2DictElement &element) -> uint32_t
+    {
+        return db2HashIndex::Combine(db2HashIndex::Hash(element.key), reinterpret_cast<const uint32_t &>(element.type0));
+    }
+
+    static auto Hash(const db2DictElement *elements, const uint32_t count) -> uint32_t
+    {
+        auto hash = 0x811C9DC5u; // FNV-1a offset basis
+        for (uint32_t i = 0; i < count; ++i)
+            hash = db2HashIndex::Combine(hash, db2Layout::Hash(elements[i]));
+        return hash;
+    }
+
+    static auto Less(const db2DictElement &element, const int32_t key, const char *type) -> bool
+    {
+        if (element.key != key || type == nullptr)
+            return element.key < key;
+        return std::memcmp(&element.type0, type, 4) < 0;
+    }
+
+    static auto Intern(db2Chunks &root, const db2DictElement *elements, const uint32_t count) -> uint32_t; // index of the layout of the sequence
+    static auto Intern(db2Chunks &root, const uint32_t base, const db2DictElement &element) -> uint32_t;    // index of the layout of base + element
+    static auto Sync(db2Chunks &root) -> void;                                                               // build every lazy index of the layouts of root
 
 public:
+    auto is_sorted() const -> bool { return std::islower(this->type[3]); }
+
+    auto find(const int32_t key, const char *type = nullptr) -> uint32_t // slot of key, UINT32_MAX if not found
+    {
+        if (!this->is_sorted() && this->size() >= DB2_DICT_LOOKUP_THRESHOLD)
+            this->sync_lookup();
+        return std::as_const(*this).find(key, type);
+    }
+
+    auto find(const int32_t key, const char *type = nullptr) const -> uint32_t // as find(), scanning if the key table is not built, so safe to call across threads
+    {
+        auto match = [&](uint32_t i) -> bool
+        {
+            return this->data[i].key == key && (type == nullptr || std::memcmp(&this->data[i].type0, type, 4) == 0);
+        };
+
+        auto n = this->size();
+        if (this->is_sorted())
+        {
+            auto i = this->lower_bound(key, type);
+            return i < n && match(i) ? i : UINT32_MAX;
+        }
+
+        if (this->lookup)
+            return this->lookup->find(db2HashIndex::Hash(key), match);
+
+        for (uint32_t i = 0; i < n; ++i)
+            if (match(i))
+                return i;
+        return UINT32_MAX;
+    }
+
+    auto lower_bound(const int32_t key, const char *type = nullptr) const -> uint32_t // size() if every element is less
+    {
+        auto n = this->size();
+        if (n == 0)
+            return 0;
+
+        // branchless: the loop runs a fixed log2(n) steps and compiles to conditional moves
+        auto base = this->data;
+        while (n > 1)
+        {
+            auto half = n / 2;
+            base = db2Layout::Less(base[half], key, type) ? base + half : base;
+            n -= half;
+        }
+        base += db2Layout::Less(*base, key, type);
+
+        return base - this->data;
+    }
+
+    auto sync_lookup() -> db2HashIndex & // key -> slot
+    {
+        if (!this->lookup)
+        {
+            this->lookup = new db2HashIndex{};
+            this->lookup->reserve(this->size());
+            for (uint32_t i = 0; i < this->size(); ++i)
+                this->lookup->insert(db2HashIndex::Hash(this->data[i].key), i);
+        }
+        return *this->lookup;
+    }
+};
+
+using CKLayout = db2Chunk<db2Layout>;
+
+struct db2DictSlot // caches the slot of a key under the last seen layout, for fixed-offset lookups
+{
+    const db2Chunks *root{nullptr};
+    uint32_t layout{db2Layout::Empty};
+    uint32_t index{UINT32_MAX};
+};
+
+template <typename CK_T, typename CSON_T>
+struct db2Binding;
+
+DB2_PRAGMA_PACK_ON
+
+struct db2Dict : public db2Chunk<uint32_t>
+{
+public:
+    using type_type = int32_t; // the index of its layout, see db2Layout
+
+    auto init() -> void { this->layout_i() = db2Layout::Empty; }
+
+public: // static
+    /*
+    Dicts of dotBox2d 0.0.1 stored 12-byte elements {key, type, value} and were typed "DICT", which
+    reads as this layout index. No layout is interned at it, so a dict of it is told apart after
+    loading, and Upgrade() moves it to the layout of its keys.
+    */
+    static constexpr uint32_t Legacy = 0x44494354; // "DICT"
+
+    static auto Upgrade(db2Chunks &root, const bool reverseEndian) -> void; // reverseEndian as the chunks were read
+
+public: // layout
+    auto layout_i() -> uint32_t & { return reinterpret_cast<uint32_t &>(this->type); }
+    auto layout_i() const -> const uint32_t & { return reinterpret_cast<const uint32_t &>(this->type); }
+
+    auto layout() const -> db2Layout & // null if the dict is empty
+    {
+        if (this->layout_i() == db2Layout::Empty || !this->root)
+            return nullval;
+        auto &layouts = std::as_const(*this->root).at<CKLayout>();
+        return layouts != nullval ? layouts.at(this->layout_i()) : nullval;
+    }
+
+    auto element(const uint32_t slot) const -> db2DictElement & { return this->layout().at(slot); } // key and type of the value at slot
+
+    template <typename CK_T>
+    static auto Element(const int32_t key) -> db2DictElement // key typed by CK_T
+    {
+        static_assert(has_value_type_v<CK_T> || sizeof(CK_T) == sizeof(int32_t));
+
+        auto *reflector = db2Reflector::GetReflector<CK_T>();
+        db2DictElement element{key};
+        if (reflector)
+            std::memcpy(&element.type0, reflector->type_ref, 4);
+        return element;
+    }
+
+public: // lookup
     template <typename CK_T>
-    auto find(const int32_t &key) -> db2DictElement &
+    auto find(const int32_t &key) -> uint32_t & // the value of key, null if not found
     {
-        static auto *reflector = db2Reflector::GetReflector<CK_T>();
-        static char *type = reflector ? reflector->type_ref : nullptr;
+        auto *reflector = db2Reflector::GetReflector<CK_T>();
+        return this->find(key, reflector ? reflector->type_ref : nullptr);
+    }
 
-        return this->find(key, type);
+    auto find(const int32_t &key, const char *type = nullptr) -> uint32_t & // the value of key, null if not found
+    {
+        auto slot = this->slot(key, type);
+        return slot != UINT32_MAX ? this->data[slot] : nullval;
     }
 
-    auto find(const int32_t &key, const char *type = nullptr) -> db2DictElement &
+    auto find(const int32_t &key, const char *type, db2DictSlot &slot) -> uint32_t &
     {
-        return this->db2DynArray<db2DictElement>::find(
-            [&](db2DictElement &element) -> bool
-            {
-                bool match_key = key == nullval || element.key == key;
-                bool match_type = type == nullptr || std::equal(&element.type0, &element.type0 + 4, type);
-                return match_key && match_type;
-            });
+        if (slot.root != this->root || slot.layout != this->layout_i())
+        {
+            auto &layout = this->layout();
+            slot = {this->root, this->layout_i(), layout != nullval ? layout.find(key, type) : UINT32_MAX};
+        }
+        return slot.index != UINT32_MAX ? this->data[slot.index] : nullval;
+    }
+
+    auto slot(const int32_t &key, const char *type = nullptr) const -> uint32_t // UINT32_MAX if not found
+    {
+        auto &layout = this->layout();
+        if (layout == nullval)
+            return UINT32_MAX;
+        if (key != nullval)
+            return layout.find(key, type);
+
+        for (uint32_t i = 0; i < layout.size(); ++i) // any key of type
+            if (type == nullptr || std::memcmp(&layout[i].type0, type, 4) == 0)
+                return i;
+        return UINT32_MAX;
+    }
+
+public: // sorting
+    /*
+    Sorting a dict moves it to the sorted layout of its elements, which is marked and recognized
+    again after loading (see db2Layout). Appending a key moves it to another layout, which is
+    sorted only if the key goes last.
+    */
+    auto is_sorted() const -> bool
+    {
+        auto &layout = this->layout();
+        return layout == nullval || layout.is_sorted();
+    }
+
+    auto sort() -> void
+    {
+        if (this->is_sorted())
+            return;
+
+        auto &layout = this->layout();
+        auto n = this->size();
+
+        db2DynArray<uint32_t, 16> order{};
+        order.expand(n);
+        for (uint32_t i = 0; i < n; ++i)
+            order[i] = i;
+        std::stable_sort(
+            order.data, order.data + n,
+            [&](const uint32_t a, const uint32_t b) -> bool
+            { return db2Layout::Less(layout[a], layout[b].key, &layout[b].type0); } //
+        );
+
+        db2DynArray<db2DictElement, 16> elements{};
+        db2DynArray<uint32_t, 16> values{};
+        elements.expand(n), values.expand(n);
+        for (uint32_t i = 0; i < n; ++i)
+            elements[i] = layout[order[i]], values[i] = this->data[order[i]];
+
+        this->detach();
+        std::memcpy(this->data, values.data, n * sizeof(uint32_t));
+        this->layout_i() = db2Layout::Intern(*this->root, elements.data, n);
     }
 
 public: // Element access
     template <typename CK_T = uint32_t>
     /* or at_ref */
-    auto ref(const int32_t &key) -> uint32_t & // if no such element exists, null is returned
+    auto ref(const int32_t &key) -> uint32_t & // for writing, if no such element exists, null is returned
     {
-        auto &element = this->find<CK_T>(key); // could be null
-        return element != nullval ? element.value : nullval;
+        this->detach(); // the value is written through
+        return this->find<CK_T>(key); // could be null
     }
 
     template <typename CK_T = uint32_t, typename vv_type = default_value_t<CK_T>>
     auto at(const int32_t &key) -> vv_type & // if no such element exists, null is returned
     {
-        auto &element = this->find<CK_T>(key);                                  // could be null
-        return element != nullval ? this->dereference<CK_T>(element) : nullval; // could be null
+        auto &value = this->find<CK_T>(key);                                // could be null
+        return value != nullval ? this->dereference<CK_T>(value) : nullval; // could be null
     }
 
     template <typename CK_T = uint32_t, typename vv_type = default_value_t<CK_T>>
-    auto dereference(db2DictElement &element) -> vv_type & // could be null
+    auto dereference(uint32_t &value) -> vv_type & // could be null
     {
-        // element could not be null now
-
-        this->handle_type<CK_T>(element); // necessary?
+        // value could not be null now
 
         if constexpr (has_value_type_v<CK_T>)
-            return this->root->get<CK_T>().at(element.value); // could be null
+            return this->root->get<CK_T>().at(value); // could be null
         else
-            return reinterpret_cast<vv_type &>(element.value); // not null
+            return reinterpret_cast<vv_type &>(value); // not null
     }
 
-public: // Modifiers
     template <typename CK_T>
-    auto handle_type(db2DictElement &element, bool set = false) -> void
-    {
-        static_assert(has_value_type_v<CK_T> || sizeof(CK_T) == sizeof(int32_t));
-
-        static auto *reflector = db2Reflector::GetReflector<CK_T>();
-        if (!reflector)
-            return;
+    auto bind() -> db2Binding<CK_T, db2Dict> { return db2Binding<CK_T, db2Dict>{*this}; } // see db2Binding
 
-        if (set)
-            std::memcpy(&element.type0, reflector->type_ref, 4);
-        else
-            assert(std::equal(&element.type0, &element.type0 + 4, reflector->type));
+public: // Modifiers
+    template <typename CK_T = uint32_t>
+    auto append(const int32_t &key, const uint32_t value = UINT32_MAX) -> uint32_t & // key must be new to this dict, the link is not recorded
+    {
+        this->detach();
+        this->layout_i() = db2Layout::Intern(*this->root, this->layout_i(), db2Dict::Element<CK_T>(key));
+        return this->db2ChunkArray<uint32_t>::emplace_back(value);
     }
 
     template <typename CK_T = uint32_t>
-    /* or get_ref (the dict element's value which stores the index of a linked value or stores a 32-bit POD) */
+    /* or get_ref (the dict value which stores the index of a linked value or stores a 32-bit POD) */
     auto link(const int32_t &key, const uint32_t &v_index = nullval) -> uint32_t & // performing an insertion if such key does not already exist
     {
-        auto &element = this->emplace_ref<CK_T>(key, v_index);
-        return element.value;
+        return this->emplace_ref<CK_T>(key, v_index);
     }
 
     template <typename CK_T = uint32_t, typename vv_type = default_value_t<CK_T>>
     /* or get_value (the linked value) */
     auto get(const int32_t &key) -> vv_type & // performing an insertion if such key does not already exist
     {
-        auto &element = this->emplace_ref<CK_T>(key);      // not null
-        auto &vv_value = this->dereference<CK_T>(element); // could be null
-        return vv_value != nullval ? vv_value : this->emplace_val<CK_T>(element);
+        auto &value = this->emplace_ref<CK_T>(key);      // not null
+        auto &vv_value = this->dereference<CK_T>(value); // could be null
+        return vv_value != nullval ? vv_value : this->emplace_val<CK_T>(value);
     }
 
     template <typename CK_T = uint32_t>
     /* or get_element */
-    auto emplace_ref(const int32_t &key, const uint32_t &v_index = nullval) -> db2DictElement &
+    auto emplace_ref(const int32_t &key, const uint32_t &v_index = nullval) -> uint32_t & // the value
     {
-        auto p_element = &this->find<CK_T>(key);
-        if (*p_element == nullval)
-        {
-            p_element = &this->db2DynArray<db2DictElement>::emplace_back(key); // Aggregate Initialization
-            this->handle_type<CK_T>(*p_element, true);
-        }
+        this->detach(); // the value is written through
+        auto p_value = &this->find<CK_T>(key);
+        if (*p_value == nullval)
+            p_value = &this->append<CK_T>(key);
         if (v_index != nullval)
-            p_element->value = v_index;
-        return *p_element;
+            *p_value = v_index, this->refer(p_value - this->data);
+        return *p_value;
+    }
+
+    auto refer(const uint32_t slot) -> void // record the link at slot, see db2References
+    {
+        if (this->root && this->root->references)
+            this->root->references->add(*this, slot);
     }
 
     template <typename CK_T = uint32_t, typename vv_type = default_value_t<CK_T>, typename... Args>
-    auto emplace_val(db2DictElement &element, Args &&...args) -> vv_type &
+    auto emplace_val(uint32_t &v_index, Args &&...args) -> vv_type &
     {
-        assert(element != nullval);
-        auto &v_index = element.value;
+        assert(v_index != nullval);
 
         if constexpr (has_value_type_v<CK_T>)
         {
             auto &chunk = this->root->get<CK_T>();
             if (0 <= v_index && v_index < chunk.size())
                 return chunk.emplace(v_index, std::forward<Args>(args)...);
-            else
-                return v_index = chunk.size(), chunk.emplace_back(std::forward<Args>(args)...);
+
+            v_index = chunk.size();
+            this->refer(&v_index - this->data); // before emplacing, which could move this dict
+            return chunk.emplace_back(std::forward<Args>(args)...);
         }
         else
         {
@@ -151,8 +380,8 @@ public: // Modifiers
     template <typename CK_T = uint32_t, typename vv_type = default_value_t<CK_T>, typename... Args>
     auto emplace(const int32_t &key, Args &&...args) -> vv_type &
     {
-        auto &element = this->emplace_ref<CK_T>(key);
-        return this->emplace_val<CK_T>(element, std::forward<Args>(args)...);
+        auto &value = this->emplace_ref<CK_T>(key);
+        return this->emplace_val<CK_T>(value, std::forward<Args>(args)...);
     }
 };
 
@@ -166,16 +395,17 @@ struct db2List : public db2Chunk<uint32_t>
 public: // Element access
     template <typename CK_T = value_type>
     /* or at_ref */
-    auto ref(const uint32_t index) -> value_type & // could be null
+    auto ref(const uint32_t index) -> value_type & // for writing, could be null
     {
         this->handle_type<CK_T>();
-        return this->db2DynArray<value_type>::at(index); // could be null
+        this->detach(); // the value is written through
+        return this->db2ChunkArray<value_type>::at(index); // could be null
     }
 
     template <typename CK_T = value_type, typename vv_type = default_value_t<CK_T>>
     auto at(const uint32_t index) -> vv_type & // if no such element exists, null is returned
     {
-        auto &v_index = this->db2DynArray<value_type>::at(index); // could be null
+        auto &v_index = this->db2ChunkArray<value_type>::at(index); // could be null
         return v_index != nullval ? this->dereference<CK_T>(v_index) : nullval;
     }
 
@@ -191,6 +421,9 @@ public: // Element access
             return reinterpret_cast<vv_type &>(v_index); // could be null
     }
 
+    template <typename CK_T>
+    auto bind() -> db2Binding<CK_T, db2List> { return db2Binding<CK_T, db2List>{*this}; } // see db2Binding
+
 public: // Modifiers
     template <typename CK_T>
     auto handle_type(bool set = false) -> void
@@ -198,7 +431,7 @@ public: // Modifiers
         if constexpr (!has_value_type_v<CK_T>)
             static_assert(sizeof(CK_T) == sizeof(value_type));
 
-        static auto *reflector = db2Reflector::GetReflector<CK_T>();
+        auto *reflector = db2Reflector::GetReflector<CK_T>();
         if (!reflector)
             return;
 
@@ -214,7 +447,9 @@ public: // Modifiers
     auto emplace_back_ref(const value_type &v_index = UINT32_MAX) -> value_type &
     {
         this->handle_type<CK_T>(true);
-        return this->db2DynArray<value_type>::emplace_back(v_index);
+        auto &value = this->db2ChunkArray<value_type>::emplace_back(v_index);
+        this->refer(this->size() - 1);
+        return value;
     }
 
     template <typename CK_T = value_type, typename vv_type = default_value_t<CK_T>, typename... Args>
@@ -224,15 +459,22 @@ public: // Modifiers
         if constexpr (has_value_type_v<CK_T>)
         {
             auto &chunk = this->root->get<CK_T>();
-            this->db2DynArray<value_type>::emplace_back(chunk.size());
+            this->db2ChunkArray<value_type>::emplace_back(chunk.size());
+            this->refer(this->size() - 1); // before emplacing, which could move this list
             return chunk.emplace_back(std::forward<Args>(args)...);
         }
         else
         {
-            return this->db2DynArray<value_type>::emplace_back<vv_type>(std::forward<Args>(args)...);
+            return this->db2ChunkArray<value_type>::emplace_back<vv_type>(std::forward<Args>(args)...);
         }
     }
 
+    auto refer(const uint32_t position) -> void // record the link at position, see db2References
+    {
+        if (this->root && this->root->references)
+            this->root->references->add(*this, position);
+    }
+
     // template <typename CK_T = value_type>
     // auto append_range_ref(const std::initializer_list<int32_t> &arg_list) -> void
     // {
@@ -270,6 +512,78 @@ struct db2String : public db2Chunk<char>
 
 DB2_PRAGMA_PACK_OFF
 
+/*
+db2Binding is a typed accessor of a dict or a list, with the target chunk of CK_T resolved in the
+root once, so bulk traversals dereference values without looking the chunk up for each access.
+The type is checked on binding (lists) or matched by find (dicts), rather than asserted per access.
+Chunks are held by pointers in db2Chunks, so a binding stays valid while chunks are added, and it
+could be rebound to other dicts or lists of the same root by operator(). Bind after the target
+chunk exists, since a binding to a missing chunk dereferences to null.
+*/
+template <typename CK_T, typename CSON_T>
+struct db2Binding
+{
+    using vv_type = default_value_t<CK_T>;
+    using key_type = std::conditional_t<std::is_same_v<CSON_T, db2Dict>, int32_t, uint32_t>; // key or index
+
+    CSON_T *cson{nullptr};
+    CK_T *chunk{nullptr}; // null for values stored in place, or if root has no such chunk
+
+    db2Binding(CSON_T &cson) : cson{&cson}
+    {
+        if constexpr (std::is_same_v<CSON_T, db2List>)
+            cson.template handle_type<CK_T>();
+        if constexpr (has_value_type_v<CK_T>)
+        {
+            auto &chunk = cson.root->template at<CK_T>(); // don't add the chunk by binding
+            this->chunk = chunk != nullval ? &chunk : nullptr;
+        }
+    }
+
+    auto operator()(CSON_T &cson) const -> db2Binding // the same binding on another dict or list
+    {
+        assert(cson.root == this->cson->root);
+        if constexpr (std::is_same_v<CSON_T, db2List>)
+            cson.template handle_type<CK_T>();
+
+        auto binding = *this;
+        binding.cson = &cson;
+        return binding;
+    }
+
+    auto ref(const key_type &key) const -> uint32_t & // for writing, could be null
+    {
+        this->cson->detach(); // the value is written through
+        return this->find(key);
+    }
+
+    auto find(const key_type &key) const -> uint32_t & // could be null
+    {
+        if constexpr (std::is_same_v<CSON_T, db2Dict>)
+        {
+            return this->cson->template find<CK_T>(key); // could be null
+        }
+        else
+        {
+            return this->cson->db2ChunkArray<uint32_t>::at(key); // could be null
+        }
+    }
+
+    auto at(const key_type &key) const -> vv_type & // could be null
+    {
+        auto &v_index = this->find(key);
+        return v_index != nullval ? this->dereference(v_index) : nullval;
+    }
+
+    auto dereference(uint32_t &v_index) const -> vv_type & // could be null
+    {
+        if constexpr (has_value_type_v<CK_T>)
+            return this->chunk ? this->chunk->at(v_index) : nullval; // could be null
+        else
+            return reinterpret_cast<vv_type &>(v_index);
+    }
+};
+
 using CKDict = db2Chunk<db2Dict>;
 using CKList = db2Chunk<db2List>;
 using CKString = db2Chunk<db2String>;
@@ -280,6 +594,7 @@ struct db2ChunkType_CSON
     static constexpr const char PODF[4]{'P', 'O', 'D', 'F'};
 
     static constexpr const char DIcT[4]{'D', 'I', 'c', 'T'};
+    static constexpr const char LAyt[4]{'L', 'A', 'y', 't'};
     static constexpr const char LIsT[4]{'L', 'I', 's', 'T'};
     static constexpr const char STrG[4]{'S', 'T', 'r', 'G'};
 
@@ -287,7 +602,6 @@ struct db2ChunkType_CSON
     // static constexpr const char lIsT[4]{'l', 'I', 's', 'T'};
     // static constexpr const char sTrG[4]{'s', 'T', 'r', 'G'};
 
-    static bool IsRegistered;
-    static bool RegisterType();
+    static bool RegisterType(); // called by db2Reflector::RegisterBuiltins()
 
 } DB2_NOTE(sizeof(db2ChunkType));
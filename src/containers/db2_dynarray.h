@@ -2,9 +2,13 @@
 
 #include <cstring> // std::memcpy std::memset
 #include <cassert> // assert static_assert
-#include <cstdlib> // std::malloc std::free std::realloc
-#include <cmath>   // std::log2 std::pow
+#include <cstdlib> // std::malloc std::free std::realloc std::aligned_alloc
+#include <cstddef> // std::max_align_t
 
+#include <bit>       // std::bit_ceil
+#include <algorithm> // std::max
+#include <span>
+#include <atomic>
 #include <functional>
 
 #include "common/db2_settings.h"
@@ -18,24 +22,53 @@ In order to avoid conceptual confusion, this container is not namaned as 'vector
 Know issue: when capacity increases, memory addresses of existing data could be changed.
 So, any referencing to the original data could become invalid. Only index accessasing is
 guaranteed to be safe.
+
+Alignment: db2DynArray<T, N, A> aligns heap data to A bytes (when A is larger than what malloc
+guarantees), for SIMD kernels. Inline data is only aligned to T.
+
+Small-buffer: db2DynArray<T, N> keeps up to N elements inside the object, and only allocates
+from the heap beyond that. N is 0 by default, which chunks rely on (see db2Chunk).
+
+Copy-on-write: share() makes an array co-own the buffer of another one, and any modifier
+detaches (copies) a shared buffer before mutating it. Writing through element references
+(operator[], at, data...) is not tracked, so call detach() before doing so on a shared array.
+
+Borrowed data: view() makes an array read memory it doesn't own (e.g. a mapped file or a
+message buffer), which should outlive the array. It's marked by a capacity of 0, it's never
+freed, and any modifier promotes it to an owned copy first (also by detach()).
 */
 
-#define DB2_DYNARRAY_CONSTRUCTORS(CLS)                                                                     \
-    CLS() = default;                                                                                       \
-    CLS(const CLS &other) { this->copy(other); }                                                           \
-    CLS(CLS &&other) { this->move(std::move(other)); }                                                     \
-    CLS(const std::initializer_list<typename CLS::value_type> &arg_list) { this->append_range(arg_list); } \
-    virtual ~CLS() { this->clear(); }                                                                      \
-    CLS &operator=(const CLS &other) { return this->copy(other), *this; }                                  \
-    CLS &operator=(CLS &&other) { return this->move(std::move(other)), *this; }                            \
-    bool operator==(const CLS &other) const { return this->equal(other); }                                 \
+#define DB2_DYNARRAY_CONSTRUCTORS(CLS)                                                                               \
+    CLS() = default;                                                                                                 \
+    CLS(const CLS &other) { this->copy(other); }                                                                     \
+    CLS(CLS &&other) { this->move(std::move(other)); }                                                               \
+    CLS(const std::initializer_list<typename CLS::value_type> &arg_list) { this->append_range(arg_list); }           \
+    virtual ~CLS() { this->clear(); }                                                                                \
+    CLS &operator=(const CLS &other) { return this != &other ? (this->clear(), this->copy(other)) : void(), *this; } \
+    CLS &operator=(CLS &&other) { return this->move(std::move(other)), *this; }                                      \
+    bool operator==(const CLS &other) const { return this->equal(other); }                                           \
     bool operator!=(const CLS &other) const { return !this->equal(other); }
 
+template <typename T, uint32_t N>
+struct db2InlineBuffer
+{
+    alignas(T) char bytes[N * sizeof(T)];
+};
+
 template <typename T>
+struct db2InlineBuffer<T, 0>
+{
+};
+
+template <typename T, uint32_t N = 0, uint32_t A = 0>
 class db2DynArray
 {
+    static_assert(A == 0 || std::has_single_bit(A));
+
 public:
     using value_type = T;
+    static constexpr uint32_t inline_capacity = N;
+    static constexpr uint32_t alignment = A;
 
 public:
     T *data{nullptr};
@@ -43,6 +76,20 @@ public:
 protected:
     uint32_t length_mem{0}; // length in bytes
 
+    mutable std::atomic<uint32_t> *shares{nullptr}; // owners of a shared data, nullptr if not shared
+
+    [[no_unique_address]] db2InlineBuffer<T, N> buffer; // small-buffer, no space taken when N is 0
+
+    auto inline_data() -> T * { return reinterpret_cast<T *>(&this->buffer); }
+
+public:
+    auto is_inline() const -> bool
+    {
+        if constexpr (N > 0)
+            return this->data == reinterpret_cast<const T *>(&this->buffer);
+        return false;
+    }
+
 public:
     const uint32_t size() const { return this->length / sizeof(T); }
     const uint32_t capacity() const { return this->length_mem / sizeof(T); }
@@ -57,14 +104,20 @@ public: // constructors and initiators
         if (!this->data)
             return; // length should be 0
 
-        if constexpr (!std::is_trivially_destructible_v<T>)
-            for (int32_t i = 0; i < this->size(); ++i)
-                (this->data + i)->~T();
-
-        std::free(this->data);
+        if (this->is_inline())
+        {
+            if constexpr (!std::is_trivially_destructible_v<T>)
+                for (uint32_t i = 0; i < this->size(); ++i)
+                    (this->data + i)->~T();
+        }
+        else if (!this->is_view()) // borrowed data is left to its owner
+        {
+            db2DynArray::Release(this->data, this->size(), this->shares);
+        }
         this->data = nullptr;
         this->length = 0;
         this->length_mem = 0;
+        this->shares = nullptr;
     }
 
     auto copy(const db2DynArray &other) -> void
@@ -88,8 +141,10 @@ public: // constructors and initiators
     auto move(db2DynArray &&other) -> void
     {
         this->clear();
-        std::memcpy(this, &other, sizeof(*this));
-        std::memset(&other, 0, sizeof(*this));
+        std::memcpy((void *)this, (void *)&other, sizeof(*this));
+        if (other.is_inline())
+            this->data = this->inline_data(); // elements are moved along with the buffer
+        std::memset((void *)&other, 0, sizeof(*this));
     };
 
     auto equal(const db2DynArray &other) const -> bool
@@ -98,6 +153,108 @@ public: // constructors and initiators
                std::memcmp(this->data, other.data, this->length) == 0;
     };
 
+public: // copy-on-write
+    auto share(const db2DynArray &other) -> void // co-own the data of other, until either of them is modified
+    {
+        if (this == &other || (this->data == other.data && this->shares))
+            return;
+
+        this->clear();
+        if (!other.data)
+            return;
+
+        if (other.is_inline())
+            return this->copy(other); // cheap enough, and inline data could not be shared
+        if (other.is_view())
+            return this->view(other.data, other.size()); // borrow from the same owner
+
+        if (!other.shares)
+            other.shares = new std::atomic<uint32_t>{1};
+        other.shares->fetch_add(1, std::memory_order_relaxed);
+
+        this->data = other.data;
+        this->length = other.length;
+        this->length_mem = other.length_mem;
+        this->shares = other.shares;
+    }
+
+    auto is_shared() const -> bool { return this->shares && this->shares->load(std::memory_order_acquire) > 1; }
+
+    auto detach() -> void // take a private copy of the data if it is shared or borrowed
+    {
+        if (this->is_view())
+            return this->promote();
+        if (!this->shares)
+            return;
+
+        if (this->shares->load(std::memory_order_acquire) == 1) // the others have gone
+        {
+            delete this->shares;
+            this->shares = nullptr;
+            return;
+        }
+
+        auto data = this->data;
+        auto shares = this->shares;
+
+        *(void **)(&this->data) = db2DynArray::Allocate(this->length_mem);
+        if constexpr (std::is_trivially_copyable_v<T>)
+            std::memcpy((void *)this->data, data, this->length);
+        else
+            for (uint32_t i = 0; i < this->size(); ++i)
+                ::new (this->data + i) T(data[i]);
+        this->shares = nullptr;
+
+        db2DynArray::Release(data, this->size(), shares);
+    }
+
+    static auto Release(T *data, const uint32_t size, std::atomic<uint32_t> *shares) -> void // drop an owner of data
+    {
+        if (shares)
+        {
+            if (shares->fetch_sub(1, std::memory_order_acq_rel) != 1)
+                return;
+            delete shares;
+        }
+
+        if constexpr (!std::is_trivially_destructible_v<T>)
+            for (uint32_t i = 0; i < size; ++i)
+                (data + i)->~T();
+
+        std::free(data);
+    }
+
+public: // borrowed data
+    auto view(const T *data, const uint32_t size) -> void // borrow data without copying, until modified
+    {
+        this->clear();
+        if (!data || size == 0)
+            return;
+
+        *(const void **)(&this->data) = data;
+        this->length = size * sizeof(T);
+        // length_mem stays 0, which marks the data as borrowed
+    }
+
+    auto is_view() const -> bool { return this->data && this->length_mem == 0; }
+
+private:
+    auto promote() -> void // copy borrowed data into an owned buffer
+    {
+        auto data = this->data;
+        auto length_mem = this->length;
+        if constexpr (db2DynArray::is_over_aligned)
+            length_mem = (length_mem + A - 1) & ~(A - 1);
+
+        *(void **)(&this->data) = db2DynArray::Allocate(length_mem);
+        if constexpr (std::is_trivially_copyable_v<T>)
+            std::memcpy((void *)this->data, data, this->length);
+        else
+            for (uint32_t i = 0; i < this->size(); ++i)
+                ::new (this->data + i) T(data[i]);
+        this->length_mem = length_mem;
+    }
+
 public: // Element access
     /**/
     auto operator[](const uint32_t index) const -> T & // no bounds checking
@@ -151,6 +308,7 @@ public: // Modifiers
         static_assert(sizeof(U) == sizeof(T));
         assert(0 <= index && index < this->size());
 
+        this->detach();
         auto ptr = this->data + index;
         ptr->~U();
         ::new (ptr) U(std::forward<Args>(args)...);
@@ -181,7 +339,7 @@ public: // Modifiers
         auto size = this->size(); // old size
         this->reserve(size + 1);
 
-        auto ptr = this->data + size;
+        auto ptr = this->data + index;
         ::memmove(ptr + 1, ptr, (size - index) * sizeof(U));
         ::new (ptr) U(std::forward<Args>(args)...);
         this->length += sizeof(U);
@@ -196,6 +354,7 @@ public: // Modifiers
 
         auto size = this->size(); // old size
 
+        this->detach();
         auto ptr = this->data + index;
         ptr->~U();
         ::memmove(ptr, ptr + 1, (size - index - 1) * sizeof(U));
@@ -241,6 +400,47 @@ public: // Modifiers
         this->length += sizeof(U) * size_append;
     }
 
+    auto append_span(const std::span<const T> items) -> void // reserves and copies once
+    {
+        this->insert_range(this->size(), items);
+    }
+
+    auto insert_range(const uint32_t index, const std::span<const T> items) -> void // items should not be of this array
+    {
+        auto size = this->size(); // old size
+        auto count = static_cast<uint32_t>(items.size());
+        assert(index <= size);
+        if (count == 0)
+            return;
+
+        this->reserve(size + count);
+
+        auto ptr = this->data + index;
+        std::memmove(ptr + count, ptr, (size - index) * sizeof(T));
+        if constexpr (std::is_trivially_copyable_v<T>)
+            std::memcpy(ptr, items.data(), count * sizeof(T));
+        else
+            for (uint32_t i = 0; i < count; ++i)
+                ::new (ptr + i) T(items[i]);
+        this->length += count * sizeof(T);
+    }
+
+    auto erase_range(const uint32_t index, const uint32_t count) -> void
+    {
+        auto size = this->size(); // old size
+        assert(index + count <= size);
+        if (count == 0)
+            return;
+
+        this->detach();
+        auto ptr = this->data + index;
+        if constexpr (!std::is_trivially_destructible_v<T>)
+            for (uint32_t i = 0; i < count; ++i)
+                (ptr + i)->~T();
+        std::memmove(ptr, ptr + count, (size - index - count) * sizeof(T));
+        this->length -= count * sizeof(T);
+    }
+
     template <typename T_> // for perfect forwarding
     auto push_back(T_ &&t) -> T &
     {
@@ -249,6 +449,7 @@ public: // Modifiers
 
     auto pop_back() -> void
     {
+        this->detach();
         (this->data + this->size() - 1)->~T();
         this->length -= sizeof(T);
     }
@@ -271,6 +472,7 @@ public: // Modifiers
         auto old_size = this->size();
         if (size < old_size)
         {
+            this->detach();
             for (uint32_t i = size; i < old_size; ++i)
                 (this->data + i)->~T();
             this->length = size * sizeof(T);
@@ -283,6 +485,38 @@ public: // Modifiers
         this->shrink(size);
     }
 
+    auto shrink_to_fit() -> void
+    {
+        if (!this->data || this->is_inline() || this->is_view() || this->length == this->length_mem)
+            return;
+        if (this->length == 0)
+            return this->clear();
+
+        this->detach();
+        if constexpr (N > 0)
+            if (this->length <= sizeof(this->buffer))
+            {
+                if constexpr (std::is_trivially_copyable_v<T>)
+                    std::memcpy(this->inline_data(), this->data, this->length);
+                else
+                    for (uint32_t i = 0; i < this->size(); ++i)
+                        ::new (this->inline_data() + i) T(std::move(this->data[i])), (this->data + i)->T::~T(); // of T exactly, moved-from arrays are zeroed with their vptr
+                std::free(this->data);
+                this->data = this->inline_data();
+                this->length_mem = sizeof(this->buffer);
+                return;
+            }
+
+        auto length_mem = this->length;
+        if constexpr (db2DynArray::is_over_aligned)
+            length_mem = (length_mem + A - 1) & ~(A - 1);
+        if (length_mem == this->length_mem)
+            return;
+
+        *(void **)(&this->data) = db2DynArray::Reallocate(this->data, this->length, length_mem);
+        this->length_mem = length_mem;
+    }
+
 public:
     auto find_index(const std::function<bool(T &)> &func) const -> uint32_t
     {
@@ -316,29 +550,88 @@ public:
 public:
     auto reserve(const uint32_t capacity, const bool exp = true) -> void { this->reserve_mem(capacity * sizeof(T), exp); }
 
+    static constexpr bool is_over_aligned = A > alignof(std::max_align_t);
+
+    static auto Allocate(const uint32_t length_mem) -> void *
+    {
+        if constexpr (db2DynArray::is_over_aligned)
+            return std::aligned_alloc(A, (length_mem + A - 1) & ~(A - 1)); // size should be a multiple of A
+        else
+            return std::malloc(length_mem);
+    }
+
+    static auto Reallocate(void *data, const uint32_t length, const uint32_t length_mem) -> void *
+    {
+        if constexpr (db2DynArray::is_over_aligned) // realloc doesn't promise the alignment, but mostly keeps it
+        {
+            if (!data)
+                return db2DynArray::Allocate(length_mem);
+
+            auto data_new = std::realloc(data, length_mem);
+            if (reinterpret_cast<uintptr_t>(data_new) % A == 0)
+                return data_new;
+
+            auto data_aligned = db2DynArray::Allocate(length_mem); // misaligned, copy once more
+            std::memcpy(data_aligned, data_new, length), std::free(data_new);
+            return data_aligned;
+        }
+        else
+        {
+            return std::realloc(data, length_mem);
+        }
+    }
+
+    static auto Grow(const uint32_t length_mem_old, const uint32_t length_mem) -> uint32_t // growth policy
+    {
+        uint64_t length_mem_exp = std::max<uint64_t>(
+            length_mem,
+            uint64_t(length_mem_old) * DB2_DYNARRAY_GROWTH_NUM / DB2_DYNARRAY_GROWTH_DEN);
+
+        if constexpr (DB2_DYNARRAY_GROWTH_NUM == 2 * DB2_DYNARRAY_GROWTH_DEN)
+            length_mem_exp = std::bit_ceil(length_mem_exp);
+        else
+            length_mem_exp = (length_mem_exp + 15) & ~uint64_t(15);
+
+        assert(length_mem_exp <= UINT32_MAX); // 4GB
+        return static_cast<uint32_t>(length_mem_exp);
+    }
+
     TYPE_IRRELATIVE auto reserve_mem(uint32_t length_mem, const bool exp = true) -> void
     {
+        this->detach(); // every appending modifier comes through here
+
         if (length_mem <= this->length_mem)
             return;
 
-        if (exp)
-        {
-            auto exp = std::ceil(std::log2(length_mem));
-            auto length_mem_exp = std::ceil(std::pow(2, exp));
+        if constexpr (N > 0)
+            if (!this->data && length_mem <= sizeof(this->buffer))
+            {
+                this->data = this->inline_data();
+                this->length_mem = sizeof(this->buffer);
+                return;
+            }
 
-            assert(length_mem_exp <= UINT32_MAX); // 4GB
-            assert(length_mem_exp >= length_mem);
+        if (exp)
+            length_mem = db2DynArray::Grow(this->length_mem, length_mem);
+        if constexpr (db2DynArray::is_over_aligned)
+            length_mem = (length_mem + A - 1) & ~(A - 1);
 
-            length_mem = length_mem_exp;
+        if (this->is_inline()) // spill to the heap
+        {
+            auto data = db2DynArray::Allocate(length_mem);
+            std::memcpy(data, this->data, this->length);
+            *(void **)(&this->data) = data;
+        }
+        else
+        {
+            *(void **)(&this->data) = db2DynArray::Reallocate(this->data, this->length, length_mem);
         }
-
-        *(void **)(&this->data) = std::realloc(this->data, length_mem);
         this->length_mem = length_mem;
     }
 };
 
-template <typename T, trivialC_or_void T_pfx = void>
-class db2DynArrayWithPrefix : public db2DynArray<T>
+template <typename T, trivialC_or_void T_pfx = void, uint32_t A = 0>
+class db2DynArrayWithPrefix : public db2DynArray<T, 0, A>
 {
 
 public:
@@ -366,13 +659,13 @@ public: // constructors and initiators
         }
 
         // clear base
-        this->db2DynArray<T>::clear();
+        this->db2DynArray<T, 0, A>::clear();
     }
 
     auto copy(const db2DynArrayWithPrefix &other) -> void
     {
         // copy base
-        this->db2DynArray<T>::copy(other);
+        this->db2DynArray<T, 0, A>::copy(other);
 
         // copy derived (pfx)
         if constexpr (!std::is_void_v<T_pfx>)
@@ -388,13 +681,13 @@ public: // constructors and initiators
     auto move(db2DynArrayWithPrefix &&other) -> void
     {
         this->clear();
-        std::memcpy(this, &other, sizeof(*this));
-        std::memset(&other, 0, sizeof(*this));
+        std::memcpy((void *)this, (void *)&other, sizeof(*this));
+        std::memset((void *)&other, 0, sizeof(*this));
     }
 
     auto equal(const db2DynArrayWithPrefix &other) const -> bool
     {
-        return static_cast<db2DynArray<T> &>(*this) == static_cast<db2DynArray<T> &>(other) &&
+        return static_cast<db2DynArray<T, 0, A> &>(*this) == static_cast<db2DynArray<T, 0, A> &>(other) &&
                this->length_pfx == other.length_pfx &&
                std::memcmp(this->prefix, other.prefix, this->length_pfx) == 0;
     }
@@ -0,0 +1,120 @@
+#pragma once
+
+#include <bit> // std::bit_ceil
+
+#include "db2_dynarray.h"
+
+/*
+db2HashIndex is an open-addressing (linear probing) hash table of uint32_t indices, which
+point into some other array owned by the user. The hash is stored next to each index, so the
+table is able to grow without access to the indexed items.
+
+Entries with equal hashes are probed in insertion order, so find() returns the first inserted
+entry accepted by the matcher, as a linear scan over the indexed array would do.
+*/
+
+class db2HashIndex
+{
+public:
+    struct Slot
+    {
+        uint32_t hash{0};
+        uint32_t index{UINT32_MAX};
+    };
+
+    static auto Hash(const int32_t key) -> uint32_t
+    {
+        auto h = static_cast<uint32_t>(key) * 0x9E3779B1u; // Fibonacci hashing
+        return h ^ (h >> 16);
+    }
+
+    static auto Combine(const uint32_t seed, const uint32_t hash) -> uint32_t
+    {
+        return (seed ^ hash) * 0x01000193u; // FNV-1a step
+    }
+
+public:
+    db2DynArray<Slot> slots{};
+    uint32_t count{0};
+
+public:
+    db2HashIndex() = default;
+
+    auto clear() -> void
+    {
+        this->slots.clear();
+        this->count = 0;
+    }
+
+    template <typename Match>
+    auto find(const uint32_t hash, const Match &match) const -> uint32_t // UINT32_MAX if not found
+    {
+        if (this->count == 0)
+            return UINT32_MAX;
+
+        auto mask = this->slots.size() - 1;
+        for (auto s = hash & mask;; s = (s + 1) & mask)
+        {
+            auto &slot = this->slots[s];
+            if (slot.index == UINT32_MAX)
+                return UINT32_MAX;
+            if (slot.hash == hash && match(slot.index))
+                return slot.index;
+        }
+    }
+
+    template <typename Func>
+    auto for_each(const uint32_t hash, const Func &func) const -> void // every entry of hash, in insertion order
+    {
+        if (this->count == 0)
+            return;
+
+        auto mask = this->slots.size() - 1;
+        for (auto s = hash & mask; this->slots[s].index != UINT32_MAX; s = (s + 1) & mask)
+            if (this->slots[s].hash == hash)
+                func(this->slots[s].index);
+    }
+
+    auto insert(const uint32_t hash, const uint32_t index) -> void
+    {
+        if ((this->count + 1) * 2 > this->slots.size()) // keep the load factor at or below 1/2
+            this->rehash(std::bit_ceil((this->count + 1) * 2));
+
+        auto mask = this->slots.size() - 1;
+        auto s = hash & mask;
+        while (this->slots[s].index != UINT32_MAX)
+            s = (s + 1) & mask;
+        this->slots[s] = {hash, index};
+        ++this->count;
+    }
+
+    auto reserve(const uint32_t count) -> void
+    {
+        if (count * 2 > this->slots.size())
+            this->rehash(std::bit_ceil(count * 2));
+    }
+
+private:
+    auto rehash(const uint32_t capacity) -> void
+    {
+        db2DynArray<Slot> old{};
+        old.move(std::move(this->slots));
+        this->slots.init(capacity);
+        this->count = 0;
+
+        auto size = old.size();
+        if (size == 0)
+            return;
+
+        // start right after an empty slot, so no probe sequence wraps around the start,
+        // and entries of equal hashes are re-inserted in their original order.
+        auto start = old.find_index([](Slot &slot)
+                                    { return slot.index == UINT32_MAX; });
+        for (auto i = 1u; i <= size; ++i)
+        {
+            auto &slot = old[(start + i) % size];
+            if (slot.index != UINT32_MAX)
+                this->insert(slot.hash, slot.index);
+        }
+    }
+};
@@ -0,0 +1,117 @@
+#include "db2_references.h"
+
+#include "db2_cson.h"
+
+auto db2References::build(db2Chunks &chunks) -> void
+{
+    this->detach();
+    this->entries.clear();
+    this->table.clear();
+
+    this->chunks = &chunks;
+    chunks.references = this;
+
+    auto &dicts = chunks.at<CKDict>();
+    for (uint32_t d = 0; dicts != nullval && d < dicts.size(); ++d)
+        for (uint32_t e = 0; e < dicts[d].size(); ++e)
+            this->add(dicts[d], e);
+
+    auto &lists = chunks.at<CKList>();
+    for (uint32_t l = 0; lists != nullval && l < lists.size(); ++l)
+        for (uint32_t v = 0; v < lists[l].size(); ++v)
+            this->add(lists[l], v);
+}
+
+auto db2References::detach() -> void
+{
+    if (this->chunks && this->chunks->references == this)
+        this->chunks->references = nullptr;
+    this->chunks = nullptr;
+}
+
+db2Chunks::~db2Chunks()
+{
+    if (this->references)
+        this->references->detach();
+
+    for (auto i = 0; i < this->size(); ++i)
+        delete this->data[i];
+}
+
+auto db2References::add(db2Dict &dict, const uint32_t slot) -> void
+{
+    auto &dicts = this->chunks->at<CKDict>();
+    if (dicts == nullval || &dict < dicts.data || &dict >= dicts.data + dicts.size())
+        return; // not a dict of the pool
+
+    auto value = dict[slot];
+    if (value == UINT32_MAX)
+        return;
+
+    auto &element = dict.element(slot);
+    db2Referrer referrer{dicts.reflector->id, static_cast<uint32_t>(&dict - dicts.data), element.key};
+    this->insert(db2Reflector::GetReflector(&element.type0), value, referrer);
+}
+
+auto db2References::add(db2List &list, const uint32_t position) -> void
+{
+    auto &lists = this->chunks->at<CKList>();
+    if (lists == nullval || &list < lists.data || &list >= lists.data + lists.size())
+        return; // not a list of the pool
+
+    auto value = list[position];
+    if (value == UINT32_MAX)
+        return;
+
+    db2Referrer referrer{lists.reflector->id, static_cast<uint32_t>(&list - lists.data), static_cast<int32_t>(position)};
+    this->insert(db2Reflector::GetReflector(list.type), value, referrer);
+}
+
+auto db2References::insert(const db2Reflector *reflector, const uint32_t index, const db2Referrer &referrer) -> void
+{
+    if (!reflector || !reflector->is_chunk || reflector->id == UINT32_MAX || this->chunks->at(reflector) == nullval)
+        return; // value in place, or link to a missing pool
+
+    auto id = reflector->id;
+    auto hash = db2References::Hash(id, index);
+
+    bool found = false;
+    this->table.for_each(hash, [&](uint32_t i)
+                         {
+                             auto &entry = this->entries[i];
+                             found |= entry.id == id && entry.index == index &&
+                                      entry.referrer.id == referrer.id &&
+                                      entry.referrer.index == referrer.index &&
+                                      entry.referrer.key == referrer.key; //
+                         });
+    if (found)
+        return;
+
+    this->table.insert(hash, this->entries.size());
+    this->entries.push_back(Entry{id, index, referrer});
+}
+
+auto db2References::holds(const Entry &entry) const -> bool
+{
+    auto &pool = this->chunks->at(db2Reflector::reflectors[entry.referrer.id]);
+    if (pool == nullval)
+        return false;
+
+    auto reflector = db2Reflector::reflectors[entry.id];
+    if (pool.reflector == db2Reflector::GetReflector<CKDict>())
+    {
+        auto &dict = reinterpret_cast<CKDict &>(pool).at(entry.referrer.index);
+        if (dict == nullval)
+            return false;
+        auto &value = dict.find(entry.referrer.key, reflector->type_ref);
+        return value != nullval && value == entry.index;
+    }
+    else
+    {
+        auto &list = reinterpret_cast<CKList &>(pool).at(entry.referrer.index);
+        if (list == nullval || db2Reflector::GetReflector(list.type) != reflector)
+            return false;
+        auto &value = list.db2ChunkArray<uint32_t>::at(entry.referrer.key);
+        return value != nullval && value == entry.index;
+    }
+}
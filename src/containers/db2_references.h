@@ -0,0 +1,81 @@
+#pragma once
+
+#include "db2_chunk.h"
+#include "db2_hash.h"
+
+struct db2Dict;
+struct db2List;
+
+/*
+db2References is a reverse-reference index of the CSON graph: for a value of a pool (the first
+top-level chunk of a type), it answers which dicts and lists refer to it, without scanning them.
+
+build() indexes every dict and list of the pools in one pass, and attaches the index to the root,
+so db2Dict and db2List record the links they add or rewrite (emplace_ref, emplace_val, emplace_back
+...). Links dropped or rewritten are left in the index, and every query checks a referrer still
+holds the link, so stale entries are skipped. Editing elements other than through db2Dict and
+db2List (erase, writing through ref() or link()...) requires build() again. db2Compactor rebuilds
+an attached index. The index is not owned by the chunks, and either one detaches the other when
+destroyed first, so neither is left with a dangling pointer.
+*/
+
+struct db2Referrer
+{
+    uint32_t id;    // reflector id of the pool of the referring dict or list
+    uint32_t index; // index of the referring dict or list in its pool
+    int32_t key;    // key of the dict element, or position in the list
+};
+
+class db2References
+{
+public:
+    db2Chunks *chunks{nullptr};
+
+private:
+    struct Entry
+    {
+        uint32_t id;    // reflector id of the pool of the referred value
+        uint32_t index; // index of the referred value in its pool
+        db2Referrer referrer;
+    };
+
+    db2DynArray<Entry> entries{};
+    db2HashIndex table{}; // (id, index) -> entries
+
+public:
+    db2References() = default;
+    db2References(const db2References &) = delete; // the chunks point back to one index
+    db2References &operator=(const db2References &) = delete;
+    ~db2References() { this->detach(); }
+
+    auto build(db2Chunks &chunks) -> void; // (re)index chunks, and attach to them
+    auto detach() -> void;                 // stop recording links of the attached chunks
+
+    auto add(db2Dict &dict, const uint32_t slot) -> void; // record the link held by dict[slot]
+    auto add(db2List &list, const uint32_t position) -> void;
+
+    template <typename CK_T, typename Func>
+    auto for_each(const uint32_t index, const Func &func) const -> void // func(const db2Referrer &) for each referrer of a value of CK_T
+    {
+        auto reflector = db2Reflector::GetReflector<CK_T>();
+        if (!reflector)
+            return;
+
+        auto id = reflector->id;
+        this->table.for_each(db2References::Hash(id, index), [&](uint32_t i)
+                             {
+                                 auto &entry = this->entries[i];
+                                 if (entry.id == id && entry.index == index && this->holds(entry))
+                                     func(entry.referrer); //
+                             });
+    }
+
+private:
+    static auto Hash(const uint32_t id, const uint32_t index) -> uint32_t
+    {
+        return db2HashIndex::Combine(db2HashIndex::Hash(id), db2HashIndex::Hash(index));
+    }
+
+    auto insert(const db2Reflector *reflector, const uint32_t index, const db2Referrer &referrer) -> void;
+    auto holds(const Entry &entry) const -> bool; // whether the referrer still holds the link
+};
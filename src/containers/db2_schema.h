@@ -0,0 +1,142 @@
+#pragma once
+
+#include <tuple>
+#include <utility> // std::index_sequence
+
+#include "db2_cson.h"
+
+/*
+db2Schema describes the fields (key and chunk type) a dict is expected to hold, and gives typed
+access to them by position rather than by key search.
+
+Fields are resolved against the layout of a dict (see db2Layout), so dicts of the same key
+sequence are resolved once, and binding another such dict only compares its layout index. Target chunks
+are resolved once per root, so bind after they exist. A dict is valid if it holds every required
+field, otherwise missing fields read as null.
+
+    struct db2BodyView : public db2Schema<db2Field<db2Key::Base, CKBody>, ...>
+    {
+        auto base() -> db2Body & { return this->get<0>(); }
+    };
+*/
+
+template <int32_t KEY, typename CK_T, bool REQUIRED = true>
+struct db2Field
+{
+    static constexpr int32_t key = KEY;
+    static constexpr bool required = REQUIRED;
+    using chunk_type = CK_T;
+    using vv_type = default_value_t<CK_T>;
+};
+
+template <typename... Fields>
+class db2Schema
+{
+public:
+    static constexpr uint32_t size = sizeof...(Fields);
+
+    template <uint32_t I>
+    using field_type = std::tuple_element_t<I, std::tuple<Fields...>>;
+
+public:
+    db2Dict *dict{nullptr}; // nullptr if bound to null
+
+private:
+    db2Chunks *root{nullptr};
+    uint32_t layout{db2Layout::Empty}; // index in the layouts of root
+    bool resolved{false};
+    bool valid{false};
+
+    uint32_t slots[size]{}; // value index of each field under layout, UINT32_MAX if absent
+    void *chunks[size]{};   // target chunk of each field in root, nullptr for values stored in place
+
+public:
+    auto bind(db2Dict &dict) -> bool // false if a required field is missing
+    {
+        if (dict == nullval)
+            return this->dict = nullptr, this->valid = false;
+        this->dict = &dict;
+
+        if (dict.root != this->root)
+        {
+            this->root = dict.root;
+            this->resolve_chunks(std::make_index_sequence<size>{});
+            this->resolved = false;
+        }
+
+        if (!this->resolved || dict.layout_i() != this->layout)
+        {
+            this->layout = dict.layout_i();
+            this->resolved = true;
+            this->valid = this->resolve_slots(dict.layout(), std::make_index_sequence<size>{});
+        }
+        return this->valid;
+    }
+
+    auto is_valid() const -> bool { return this->valid; }
+
+    template <uint32_t I>
+    auto ref() const -> uint32_t & // for writing, could be null
+    {
+        if (this->dict)
+            this->dict->detach(); // the value is written through
+        return this->find<I>();
+    }
+
+    template <uint32_t I>
+    auto find() const -> uint32_t & // could be null
+    {
+        auto slot = this->slots[I];
+        return this->dict && slot != UINT32_MAX ? this->dict->data[slot] : nullval;
+    }
+
+    template <uint32_t I, typename F = field_type<I>>
+    auto get() const -> typename F::vv_type & // could be null
+    {
+        auto &v_index = this->find<I>();
+        if (v_index == nullval)
+            return nullval;
+
+        if constexpr (has_value_type_v<typename F::chunk_type>)
+        {
+            auto chunk = static_cast<typename F::chunk_type *>(this->chunks[I]);
+            return chunk ? chunk->at(v_index) : nullval; // could be null
+        }
+        else
+        {
+            return reinterpret_cast<typename F::vv_type &>(v_index);
+        }
+    }
+
+private:
+    template <typename F>
+    static auto Type() -> const char * // as matched by db2Dict::find<CK_T>
+    {
+        auto *reflector = db2Reflector::GetReflector<typename F::chunk_type>();
+        return reflector ? reflector->type_ref : nullptr;
+    }
+
+    template <std::size_t... I>
+    auto resolve_chunks(std::index_sequence<I...>) -> void
+    {
+        ((this->chunks[I] = this->resolve_chunk<field_type<I>>()), ...);
+    }
+
+    template <typename F>
+    auto resolve_chunk() -> void *
+    {
+        if constexpr (has_value_type_v<typename F::chunk_type>)
+        {
+            auto &chunk = std::as_const(*this->root).template at<typename F::chunk_type>();
+            return chunk != nullval ? &chunk : nullptr;
+        }
+        return nullptr;
+    }
+
+    template <std::size_t... I>
+    auto resolve_slots(const db2Layout &layout, std::index_sequence<I...>) -> bool
+    {
+        ((this->slots[I] = layout != nullval ? layout.find(field_type<I>::key, db2Schema::Type<field_type<I>>()) : UINT32_MAX), ...);
+        return ((!field_type<I>::required || this->slots[I] != UINT32_MAX) && ...);
+    }
+};
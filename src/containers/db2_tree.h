@@ -56,7 +56,7 @@ public: // end value
     auto at(uint32_t index) -> T &
     {
         assert(this->is_end());
-        return this->db2DynArray<T>::at(index);
+        return this->db2ChunkArray<T>::at(index);
     }
 
     template <typename... Args>
@@ -9,6 +9,7 @@ struct db2Key
     {
         Type = 0x0001, // the type of a dict, if base is specified, it is can be omitted.
         Base = 0x0002, // the base stucture of a dict.
+        Derived = 0x0003, // values derived from the others of a dict, which could be recomputed.
     };
 
     /* file */
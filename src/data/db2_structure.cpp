@@ -2,8 +2,6 @@
 
 #include <fstream>
 
-bool db2ChunkType::IsRegistered = db2ChunkType::RegisterType();
-
 auto db2ChunkType::RegisterType() -> bool
 {
     db2Reflector::Reflect<CKInfo>(db2ChunkType::INFO);
@@ -12,6 +10,10 @@ auto db2ChunkType::RegisterType() -> bool
     db2Reflector::Reflect<CKBody>(db2ChunkType::BODY);
     db2Reflector::Reflect<CKFixture>(db2ChunkType::FXTR);
     db2Reflector::Reflect<CKShape>(db2ChunkType::SHpE);
+    db2Reflector::Reflect<CKDerived>(db2ChunkType::DRvd);
+    db2Reflector::Reflect<CKState>(db2ChunkType::STAt);
+    db2Reflector::Reflect<CKStateQ>(db2ChunkType::STQt);
+    db2Reflector::Reflect<CKFrameBase>(db2ChunkType::FRMt);
 
     return true;
 }
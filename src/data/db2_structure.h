@@ -48,6 +48,51 @@ ENDIAN_SENSITIVE struct db2Joint : public db2ChunkStruct<float32_t>
 {
 };
 
+ENDIAN_SENSITIVE struct db2Derived : public db2ChunkStruct<float32_t>
+{
+    // derived from a fixture and its shape by db2Decoder::Encode_Derived, type3 is the shape type
+    // 0: hash of the values derived from (bits of a uint32_t), see db2Decoder::Hash_Derived
+    // 1-4: mass, center (x, y), I
+    // polygons, 5-6: centroid (x, y), 7-n: normals
+};
+
+ENDIAN_SENSITIVE struct db2State
+{
+    // the dynamic state of a body in a frame, see db2Frame
+    float32_t position_x{0.0f};
+    float32_t position_y{0.0f};
+    float32_t angle{0.0f};
+    float32_t linearVelocity_x{0.0f};
+    float32_t linearVelocity_y{0.0f};
+    float32_t angularVelocity{0.0f};
+    bool awake{true};
+    /* 3 bytes gape*/
+
+} DB2_ASSERT(sizeof(db2State) == 28);
+
+ENDIAN_SENSITIVE struct db2StateQ
+{
+    // db2State quantized by DB2_FRAME_POSITION_STEP and DB2_FRAME_VELOCITY_STEP, values out of range are clamped
+    int32_t position_x{0};
+    int32_t position_y{0};
+    int16_t angle{0}; // normalized to [-pi, pi], the rest of turns
+    int16_t linearVelocity_x{0};
+    int16_t linearVelocity_y{0};
+    int16_t angularVelocity{0};
+    bool awake{true};
+    /* 1 byte gape */
+    int16_t turns{0}; // whole turns of the angle, which Box2D does not wrap
+
+} DB2_ASSERT(sizeof(db2StateQ) == 20);
+
+ENDIAN_SENSITIVE struct db2FrameBase
+{
+    // identity of the world a frame was encoded from, see db2Frame
+    uint32_t body_count{0};
+    uint32_t body_hash{0}; // of the dict (userData) of each body and whether it is static, in list order
+
+} DB2_ASSERT(sizeof(db2FrameBase) == 8);
+
 ENDIAN_SENSITIVE struct db2World
 {
     float32_t gravity_x{0.0f};
@@ -68,7 +113,7 @@ struct db2Info
 
     uint8_t ver_dotBox2d_0{0};
     uint8_t ver_dotBox2d_1{0};
-    uint8_t ver_dotBox2d_2{1};
+    uint8_t ver_dotBox2d_2{2}; // 2: dicts store values against layouts, see db2Dict::Legacy
 
     uint8_t ver_box2d_0{2};
     uint8_t ver_box2d_1{4};
@@ -84,6 +129,10 @@ using CKJoint = db2Chunk<db2Joint>;
 using CKBody = db2Chunk<db2Body>;
 using CKFixture = db2Chunk<db2Fixture>;
 using CKShape = db2Chunk<db2Shape>;
+using CKDerived = db2Chunk<db2Derived>;
+using CKState = db2Chunk<db2State>;
+using CKStateQ = db2Chunk<db2StateQ>;
+using CKFrameBase = db2Chunk<db2FrameBase>;
 
 struct db2ChunkType
 {
@@ -93,8 +142,11 @@ struct db2ChunkType
     static constexpr const char BODY[4]{'B', 'O', 'D', 'Y'};
     static constexpr const char FXTR[4]{'F', 'X', 'T', 'R'};
     static constexpr const char SHpE[4]{'S', 'H', 'p', 'E'};
+    static constexpr const char DRvd[4]{'D', 'R', 'v', 'd'};
+    static constexpr const char STAt[4]{'S', 'T', 'A', 't'};
+    static constexpr const char STQt[4]{'S', 'T', 'Q', 't'};
+    static constexpr const char FRMt[4]{'F', 'R', 'M', 't'};
 
-    static bool IsRegistered;
-    static bool RegisterType();
+    static bool RegisterType(); // called by db2Reflector::RegisterBuiltins()
 
 } DB2_NOTE(sizeof(db2ChunkType));
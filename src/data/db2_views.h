@@ -0,0 +1,41 @@
+#pragma once
+
+#include "containers/db2_schema.h"
+#include "data/db2_key.h"
+#include "data/db2_structure.h"
+
+// schemas of the dicts of Box2D objects, as written by db2Decoder::Encode
+
+struct db2WorldView : public db2Schema<db2Field<db2Key::Base, CKWorld>,
+                                       db2Field<db2Key::BODY, CKList, false>,
+                                       db2Field<db2Key::JOINT, CKList, false>>
+{
+    auto base() -> db2World & { return this->get<0>(); }
+    auto bodies() -> db2List & { return this->get<1>(); }
+    auto joints() -> db2List & { return this->get<2>(); }
+};
+
+struct db2BodyView : public db2Schema<db2Field<db2Key::Base, CKBody>,
+                                      db2Field<db2Key::FIXTURE, CKList, false>>
+{
+    auto base() -> db2Body & { return this->get<0>(); }
+    auto fixtures() -> db2List & { return this->get<1>(); }
+};
+
+struct db2FixtureView : public db2Schema<db2Field<db2Key::Base, CKFixture>,
+                                         db2Field<db2Key::SHAPE, CKShape>,
+                                         db2Field<db2Key::Derived, CKDerived, false>>
+{
+    auto base() -> db2Fixture & { return this->get<0>(); }
+    auto shape() -> db2Shape & { return this->get<1>(); }
+    auto derived() -> db2Derived & { return this->get<2>(); }
+};
+
+struct db2JointView : public db2Schema<db2Field<db2Key::Base, CKJoint>,
+                                       db2Field<db2Key::BODY, CKList, false>,   // bodyA, bodyB
+                                       db2Field<db2Key::JOINT, CKList, false>>  // joint1, joint2 of gear joints
+{
+    auto base() -> db2Joint & { return this->get<0>(); }
+    auto bodies() -> db2List & { return this->get<1>(); }
+    auto joints() -> db2List & { return this->get<2>(); }
+};
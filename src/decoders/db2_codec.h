@@ -0,0 +1,192 @@
+#pragma once
+
+#include <functional> // std::invoke
+
+#include "box2d/box2d.h"
+
+#include "common/db2_settings.h"
+
+/*
+db2Codec lays a Box2D object out as floats (of a db2Joint or a db2Shape), by a list of fields.
+Each field names the member of a def to decode into, and the getter, or member, of an object to
+encode from:
+
+    using db2WeldJointCodec = db2Codec<b2WeldJointDef, b2WeldJoint,
+                                       db2CodecField<&b2WeldJointDef::localAnchorA, &b2WeldJoint::GetLocalAnchorA>,
+                                       ...>;
+
+A field is a float32_t (1 value), a bool (1 value, 0 or 1) or a b2Vec2 (2 values), so the value
+count of a type is known at compile time, and checked once per object instead of per field.
+*/
+
+template <typename T>
+struct db2CodecValue; // how a field is stored as floats
+
+template <>
+struct db2CodecValue<float32_t>
+{
+    static constexpr uint32_t count = 1;
+    static auto Read(const float32_t *values, float32_t &v) -> void { v = values[0]; }
+    static auto Write(float32_t *values, const float32_t v) -> void { values[0] = v; }
+};
+
+template <>
+struct db2CodecValue<bool>
+{
+    static constexpr uint32_t count = 1;
+    static auto Read(const float32_t *values, bool &v) -> void { v = (bool)values[0]; }
+    static auto Write(float32_t *values, const bool v) -> void { values[0] = (float32_t)v; }
+};
+
+template <>
+struct db2CodecValue<b2Vec2>
+{
+    static constexpr uint32_t count = 2;
+    static auto Read(const float32_t *values, b2Vec2 &v) -> void { v = {values[0], values[1]}; }
+    static auto Write(float32_t *values, const b2Vec2 &v) -> void { values[0] = v.x, values[1] = v.y; }
+};
+
+template <typename T>
+struct db2MemberPointer;
+
+template <typename C, typename M>
+struct db2MemberPointer<M C::*>
+{
+    using member_type = M;
+};
+
+template <auto DEF_MEMBER, auto GETTER = DEF_MEMBER>
+struct db2CodecField
+{
+    using value_type = typename db2MemberPointer<decltype(DEF_MEMBER)>::member_type;
+    static constexpr uint32_t count = db2CodecValue<value_type>::count;
+
+    template <typename T_DEF>
+    static auto Decode(const float32_t *values, T_DEF &def) -> void { db2CodecValue<value_type>::Read(values, def.*DEF_MEMBER); }
+
+    template <typename T_OBJ>
+    static auto Encode(T_OBJ &object, float32_t *values) -> void { db2CodecValue<value_type>::Write(values, std::invoke(GETTER, object)); }
+};
+
+template <typename T_DEF, typename T_OBJ, typename... Fields>
+struct db2Codec
+{
+    using def_type = T_DEF;
+    using object_type = T_OBJ;
+
+    static constexpr uint32_t count = (Fields::count + ... + 0);
+
+    static auto Decode(const float32_t *values, T_DEF &def) -> void
+    {
+        ((Fields::Decode(values, def), values += Fields::count), ...);
+    }
+
+    static auto Encode(T_OBJ &object, float32_t *values) -> void
+    {
+        ((Fields::Encode(object, values), values += Fields::count), ...);
+    }
+};
+
+// getters of values which Box2D keeps in another form
+struct db2CodecGetters
+{
+    static auto PulleyLocalAnchorA(b2PulleyJoint &b2j) -> b2Vec2 { return b2j.GetBodyA()->GetLocalPoint(b2j.GetAnchorA()); }
+    static auto PulleyLocalAnchorB(b2PulleyJoint &b2j) -> b2Vec2 { return b2j.GetBodyB()->GetLocalPoint(b2j.GetAnchorB()); }
+};
+
+/* joints */ // after collideConnected, joint1 and joint2 of gear joints are linked by the joint dict
+
+using db2RevoluteJointCodec = db2Codec<b2RevoluteJointDef, b2RevoluteJoint,
+                                       db2CodecField<&b2RevoluteJointDef::localAnchorA, &b2RevoluteJoint::GetLocalAnchorA>,
+                                       db2CodecField<&b2RevoluteJointDef::localAnchorB, &b2RevoluteJoint::GetLocalAnchorB>,
+                                       db2CodecField<&b2RevoluteJointDef::referenceAngle, &b2RevoluteJoint::GetReferenceAngle>,
+                                       db2CodecField<&b2RevoluteJointDef::enableLimit, &b2RevoluteJoint::IsLimitEnabled>,
+                                       db2CodecField<&b2RevoluteJointDef::lowerAngle, &b2RevoluteJoint::GetLowerLimit>,
+                                       db2CodecField<&b2RevoluteJointDef::upperAngle, &b2RevoluteJoint::GetUpperLimit>,
+                                       db2CodecField<&b2RevoluteJointDef::enableMotor, &b2RevoluteJoint::IsMotorEnabled>,
+                                       db2CodecField<&b2RevoluteJointDef::motorSpeed, &b2RevoluteJoint::GetMotorSpeed>,
+                                       db2CodecField<&b2RevoluteJointDef::maxMotorTorque, &b2RevoluteJoint::GetMaxMotorTorque>>;
+
+using db2PrismaticJointCodec = db2Codec<b2PrismaticJointDef, b2PrismaticJoint,
+                                        db2CodecField<&b2PrismaticJointDef::localAnchorA, &b2PrismaticJoint::GetLocalAnchorA>,
+                                        db2CodecField<&b2PrismaticJointDef::localAnchorB, &b2PrismaticJoint::GetLocalAnchorB>,
+                                        db2CodecField<&b2PrismaticJointDef::localAxisA, &b2PrismaticJoint::GetLocalAxisA>,
+                                        db2CodecField<&b2PrismaticJointDef::referenceAngle, &b2PrismaticJoint::GetReferenceAngle>,
+                                        db2CodecField<&b2PrismaticJointDef::enableLimit, &b2PrismaticJoint::IsLimitEnabled>,
+                                        db2CodecField<&b2PrismaticJointDef::lowerTranslation, &b2PrismaticJoint::GetLowerLimit>,
+                                        db2CodecField<&b2PrismaticJointDef::upperTranslation, &b2PrismaticJoint::GetUpperLimit>,
+                                        db2CodecField<&b2PrismaticJointDef::enableMotor, &b2PrismaticJoint::IsMotorEnabled>,
+                                        db2CodecField<&b2PrismaticJointDef::maxMotorForce, &b2PrismaticJoint::GetMaxMotorForce>,
+                                        db2CodecField<&b2PrismaticJointDef::motorSpeed, &b2PrismaticJoint::GetMotorSpeed>>;
+
+using db2DistanceJointCodec = db2Codec<b2DistanceJointDef, b2DistanceJoint,
+                                       db2CodecField<&b2DistanceJointDef::localAnchorA, &b2DistanceJoint::GetLocalAnchorA>,
+                                       db2CodecField<&b2DistanceJointDef::localAnchorB, &b2DistanceJoint::GetLocalAnchorB>,
+                                       db2CodecField<&b2DistanceJointDef::length, &b2DistanceJoint::GetLength>,
+                                       db2CodecField<&b2DistanceJointDef::minLength, &b2DistanceJoint::GetMinLength>,
+                                       db2CodecField<&b2DistanceJointDef::maxLength, &b2DistanceJoint::GetMaxLength>,
+                                       db2CodecField<&b2DistanceJointDef::stiffness, &b2DistanceJoint::GetStiffness>,
+                                       db2CodecField<&b2DistanceJointDef::damping, &b2DistanceJoint::GetDamping>>;
+
+using db2PulleyJointCodec = db2Codec<b2PulleyJointDef, b2PulleyJoint,
+                                     db2CodecField<&b2PulleyJointDef::groundAnchorA, &b2PulleyJoint::GetGroundAnchorA>,
+                                     db2CodecField<&b2PulleyJointDef::groundAnchorB, &b2PulleyJoint::GetGroundAnchorB>,
+                                     db2CodecField<&b2PulleyJointDef::localAnchorA, &db2CodecGetters::PulleyLocalAnchorA>,
+                                     db2CodecField<&b2PulleyJointDef::localAnchorB, &db2CodecGetters::PulleyLocalAnchorB>,
+                                     db2CodecField<&b2PulleyJointDef::lengthA, &b2PulleyJoint::GetLengthA>,
+                                     db2CodecField<&b2PulleyJointDef::lengthB, &b2PulleyJoint::GetLengthB>,
+                                     db2CodecField<&b2PulleyJointDef::ratio, &b2PulleyJoint::GetRatio>>;
+
+using db2MouseJointCodec = db2Codec<b2MouseJointDef, b2MouseJoint,
+                                    db2CodecField<&b2MouseJointDef::target, &b2MouseJoint::GetTarget>,
+                                    db2CodecField<&b2MouseJointDef::maxForce, &b2MouseJoint::GetMaxForce>,
+                                    db2CodecField<&b2MouseJointDef::stiffness, &b2MouseJoint::GetStiffness>,
+                                    db2CodecField<&b2MouseJointDef::damping, &b2MouseJoint::GetDamping>>;
+
+using db2GearJointCodec = db2Codec<b2GearJointDef, b2GearJoint,
+                                   db2CodecField<&b2GearJointDef::ratio, &b2GearJoint::GetRatio>>;
+
+using db2WheelJointCodec = db2Codec<b2WheelJointDef, b2WheelJoint,
+                                    db2CodecField<&b2WheelJointDef::localAnchorA, &b2WheelJoint::GetLocalAnchorA>,
+                                    db2CodecField<&b2WheelJointDef::localAnchorB, &b2WheelJoint::GetLocalAnchorB>,
+                                    db2CodecField<&b2WheelJointDef::localAxisA, &b2WheelJoint::GetLocalAxisA>,
+                                    db2CodecField<&b2WheelJointDef::enableLimit, &b2WheelJoint::IsLimitEnabled>,
+                                    db2CodecField<&b2WheelJointDef::lowerTranslation, &b2WheelJoint::GetLowerLimit>,
+                                    db2CodecField<&b2WheelJointDef::upperTranslation, &b2WheelJoint::GetUpperLimit>,
+                                    db2CodecField<&b2WheelJointDef::enableMotor, &b2WheelJoint::IsMotorEnabled>,
+                                    db2CodecField<&b2WheelJointDef::maxMotorTorque, &b2WheelJoint::GetMaxMotorTorque>,
+                                    db2CodecField<&b2WheelJointDef::motorSpeed, &b2WheelJoint::GetMotorSpeed>,
+                                    db2CodecField<&b2WheelJointDef::stiffness, &b2WheelJoint::GetStiffness>,
+                                    db2CodecField<&b2WheelJointDef::damping, &b2WheelJoint::GetDamping>>;
+
+using db2WeldJointCodec = db2Codec<b2WeldJointDef, b2WeldJoint,
+                                   db2CodecField<&b2WeldJointDef::localAnchorA, &b2WeldJoint::GetLocalAnchorA>,
+                                   db2CodecField<&b2WeldJointDef::localAnchorB, &b2WeldJoint::GetLocalAnchorB>,
+                                   db2CodecField<&b2WeldJointDef::referenceAngle, &b2WeldJoint::GetReferenceAngle>,
+                                   db2CodecField<&b2WeldJointDef::stiffness, &b2WeldJoint::GetStiffness>,
+                                   db2CodecField<&b2WeldJointDef::damping, &b2WeldJoint::GetDamping>>;
+
+using db2FrictionJointCodec = db2Codec<b2FrictionJointDef, b2FrictionJoint,
+                                       db2CodecField<&b2FrictionJointDef::localAnchorA, &b2FrictionJoint::GetLocalAnchorA>,
+                                       db2CodecField<&b2FrictionJointDef::localAnchorB, &b2FrictionJoint::GetLocalAnchorB>,
+                                       db2CodecField<&b2FrictionJointDef::maxForce, &b2FrictionJoint::GetMaxForce>,
+                                       db2CodecField<&b2FrictionJointDef::maxTorque, &b2FrictionJoint::GetMaxTorque>>;
+
+using db2MotorJointCodec = db2Codec<b2MotorJointDef, b2MotorJoint,
+                                    db2CodecField<&b2MotorJointDef::linearOffset, &b2MotorJoint::GetLinearOffset>,
+                                    db2CodecField<&b2MotorJointDef::angularOffset, &b2MotorJoint::GetAngularOffset>,
+                                    db2CodecField<&b2MotorJointDef::maxForce, &b2MotorJoint::GetMaxForce>,
+                                    db2CodecField<&b2MotorJointDef::maxTorque, &b2MotorJoint::GetMaxTorque>,
+                                    db2CodecField<&b2MotorJointDef::correctionFactor, &b2MotorJoint::GetCorrectionFactor>>;
+
+/* shapes */ // after m_radius, shapes of vertex arrays (polygons and chains) are laid out by hand
+
+using db2CircleShapeCodec = db2Codec<b2CircleShape, b2CircleShape,
+                                     db2CodecField<&b2CircleShape::m_p>>;
+
+using db2EdgeShapeCodec = db2Codec<b2EdgeShape, b2EdgeShape,
+                                   db2CodecField<&b2EdgeShape::m_vertex0>,
+                                   db2CodecField<&b2EdgeShape::m_vertex1>,
+                                   db2CodecField<&b2EdgeShape::m_vertex2>,
+                                   db2CodecField<&b2EdgeShape::m_vertex3>,
+                                   db2CodecField<&b2EdgeShape::m_oneSided>>;
@@ -1,5 +1,12 @@
 #include "db2_decoder.h"
 
+#include <algorithm>  // std::clamp std::stable_sort
+#include <bit>        // std::bit_cast
+#include <cstring>    // std::memcpy
+#include <functional> // std::ref
+#include <thread>
+#include <vector>
+
 auto db2Decoder::Decode(dotBox2d &db2) -> void
 {
     if (db2.p_b2w)
@@ -9,8 +16,83 @@ auto db2Decoder::Decode(dotBox2d &db2) -> void
     auto &world_dict = db2.world_dict();
     if (world_dict == nullval)
         return;
-    auto &db2w = world_dict.at<CKWorld>(db2Key::Base);
 
+    // dicts are read through their schemas, which resolve fields once per key layout
+    db2WorldView world{};
+    world.bind(world_dict);
+    db2Decoder::Create_World(db2, world.base());
+
+    /*body*/ // dicts are linked by index, into the dict chunk resolved once
+    auto &dicts = db2.chunks.at<CKDict>();
+    auto &world_body_list = world.bodies();
+
+    if (world_body_list != nullval && world_body_list.size() > 0)
+    {
+        // defs are built across threads, which only read the CSON graph, then fed to the world in order
+        auto count = world_body_list.size();
+        uint32_t threads = DB2_DECODE_THREADS > 0 ? DB2_DECODE_THREADS : std::max(1u, std::thread::hardware_concurrency());
+        threads = std::clamp(count / DB2_DECODE_BATCH, 1u, threads);
+
+        db2DynArray<BodyDefs> defs{};
+        defs.init(threads);
+        db2Decoder::Prepare_Bodies(db2.chunks);
+
+        if (threads > 1)
+        {
+            std::vector<std::thread> workers{};
+            workers.reserve(threads);
+            for (uint32_t t = 0; t < threads; ++t)
+                workers.emplace_back(db2Decoder::Decode_Bodies, std::ref(dicts), std::ref(world_body_list),
+                                     uint32_t(uint64_t(count) * t / threads), uint32_t(uint64_t(count) * (t + 1) / threads), std::ref(defs[t]));
+            for (auto &worker : workers)
+                worker.join();
+        }
+        else
+        {
+            db2Decoder::Decode_Bodies(dicts, world_body_list, 0, count, defs[0]);
+        }
+
+        // every fixture is created before any broadphase proxy
+        db2DynArray<b2Body *> disabled{};
+        disabled.reserve(count, false);
+        for (uint32_t t = 0; t < threads; ++t)
+            db2Decoder::Create_Bodies(db2, defs[t], disabled);
+        db2Decoder::Enable_Bodies(disabled);
+    }
+
+    // /*test return*/ return;
+
+    /*joint*/
+    auto &world_joint_list = world.joints();
+    if (world_joint_list != nullval)
+    {
+        db2JointView joint{};
+
+        // joints in order, then passes over waiting joints, such as gear joints linking later joints,
+        // until a pass creates none of them, as db2IncrementalDecoder::step_joint does
+        db2DynArray<uint32_t> waiting{};
+        for (uint32_t j = 0; j < world_joint_list.size(); ++j)
+            if (!db2Decoder::Create_Joint(db2, dicts, world_joint_list, j, joint))
+                waiting.push_back(j);
+
+        for (auto progress = true; progress && waiting.size() > 0;)
+        {
+            progress = false;
+            uint32_t kept = 0;
+            for (uint32_t w = 0; w < waiting.size(); ++w)
+            {
+                if (db2Decoder::Create_Joint(db2, dicts, world_joint_list, waiting[w], joint))
+                    progress = true;
+                else
+                    waiting[kept++] = waiting[w];
+            }
+            waiting.shrink(kept);
+        }
+    }
+}
+
+auto db2Decoder::Create_World(dotBox2d &db2, db2World &db2w) -> void
+{
     b2Vec2 gravity;
     db2Decoder::Decode_World(db2w, gravity);
 
@@ -19,89 +101,243 @@ auto db2Decoder::Decode(dotBox2d &db2) -> void
     db2.inv_dt = db2w.inv_dt;
     db2.velocityIterations = db2w.velocityIterations;
     db2.positionIterations = db2w.positionIterations;
+}
+
+auto db2Decoder::Prepare_Bodies(db2Chunks &chunks) -> void
+{
+    // the read path of Decode_Bodies is const, and finds chunks and keys without indexing them,
+    // so chunks are indexed and key tables of layouts built here, for speed
+    chunks.sync_slots();
+    db2Layout::Sync(chunks);
+}
+
+auto db2Decoder::Decode_Bodies(CKDict &dicts, db2List &world_body_list, const uint32_t begin, const uint32_t end, BodyDefs &defs) -> void
+{
+    assert(!dicts.root || dicts.root->is_synced()); // see Prepare_Bodies
 
-    /*body*/
-    auto &world_body_list = world_dict.at<CKList>(db2Key::BODY);
+    db2BodyView body{};
+    db2FixtureView fixture{};
+    db2DynArray<b2MassData> fixture_masses{}; // of the fixtures of a body
 
-    if (world_body_list != nullval)
+    defs.bodies.reserve(end - begin, false);
+    defs.fixture_counts.reserve(end - begin, false);
+    defs.masses.reserve(end - begin, false);
+
+    for (auto b = begin; b < end; ++b)
     {
-        for (auto b = 0; b < world_body_list.size(); ++b)
+        body.bind(dicts.at(world_body_list[b]));
+
+        auto &b2bdef = defs.bodies.emplace_back();
+        db2Decoder::Decode_Body(body.base(), b2bdef);
+        /*userData*/ b2bdef.userData.pointer = (uintptr_t)world_body_list[b];
+
+        /*fixture*/
+        auto &body_fixture_list = body.fixtures();
+        uint32_t fixture_count = 0;
+        if (body_fixture_list != nullval)
         {
-            auto &body_dict = world_body_list.at<CKDict>(b);
-            auto &db2b = body_dict.at<CKBody>(db2Key::Base);
+            fixture_count = body_fixture_list.size();
 
-            b2BodyDef b2bdef{};
-            db2Decoder::Decode_Body(db2b, b2bdef);
+            for (auto f = 0; f < fixture_count; ++f)
+            {
+                fixture.bind(dicts.at(body_fixture_list[f]));
 
-            /*userData*/ b2bdef.userData.pointer = (uintptr_t)world_body_list.ref<CKDict>(b);
-            auto p_b2b = db2.p_b2w->CreateBody(&b2bdef);
-            /*.userData*/ body_dict.runtime = p_b2b;
+                auto &b2fdef = defs.fixtures.emplace_back();
+                db2Decoder::Decode_Fixture(fixture.base(), b2fdef);
+
+                // derived data is read only if the values it was derived from are unchanged
+                auto &derived = fixture.derived();
+                auto p_db2d = derived != nullval && derived.size() >= 5 &&
+                                      std::bit_cast<uint32_t>(derived[0]) == db2Decoder::Hash_Derived(fixture.base(), fixture.shape())
+                                  ? &derived
+                                  : nullptr;
+
+                /*shape*/ // the shape will be cloned
+                auto p_b2s = db2Decoder::Decode_Shpae(fixture.shape(), defs.shapes.emplace_back(), p_db2d);
+
+                /*userData*/ b2fdef.userData.pointer = (uintptr_t)body_fixture_list[f];
+
+                auto &fixture_mass = fixture_masses.emplace_back(b2MassData{0.0f, {0.0f, 0.0f}, 0.0f});
+                if (p_db2d)
+                    fixture_mass = {derived[1], {derived[2], derived[3]}, derived[4]};
+                else if (p_b2s && b2fdef.density > 0.0f)
+                    p_b2s->ComputeMass(&fixture_mass, b2fdef.density);
+            }
+        }
 
-            /*fixture*/
-            auto &body_fixture_list = body_dict.at<CKList>(db2Key::FIXTURE);
-            if (body_fixture_list != nullval)
-                for (auto f = 0; f < body_fixture_list.size(); ++f)
-                {
-                    auto &fixture_dict = body_fixture_list.at<CKDict>(f);
-                    auto &db2f = fixture_dict.at<CKFixture>(db2Key::Base);
-
-                    b2FixtureDef b2fdef{};
-                    db2Decoder::Decode_Fixture(db2f, b2fdef);
-
-                    /*shape*/
-                    b2Shape *p_b2s = nullptr;
-                    {
-                        auto &db2s = fixture_dict.at<CKShape>(db2Key::SHAPE);
-                        db2Decoder::Decode_Shpae(db2s, p_b2s);
-                    }
-
-                    b2fdef.shape = p_b2s; // The shape will be cloned
-
-                    /*userData*/ b2fdef.userData.pointer = (uintptr_t)body_fixture_list.ref<CKDict>(f);
-                    auto p_b2f = p_b2b->CreateFixture(&b2fdef);
-                    /*.userData*/ fixture_dict.runtime = p_b2f;
-
-                    if (p_b2s)
-                        delete p_b2s; // virtual ~b2Shape()
-                }
+        /*mass*/ // summed as b2Body::ResetMassData does, over the fixture list of Box2D, which is in reverse
+        b2MassData mass{0.0f, {0.0f, 0.0f}, 0.0f}; // about the body origin, as b2Body::SetMassData takes it
+        for (auto f = fixture_count; f-- > 0;)
+        {
+            auto &b2fdef = defs.fixtures[defs.fixtures.size() - fixture_count + f];
+            if (b2fdef.density <= 0.0f)
+                continue; // or without a shape, for which the fixture mass is 0
+
+            auto &fixture_mass = fixture_masses[f];
+            mass.mass += fixture_mass.mass;
+            mass.center += fixture_mass.mass * fixture_mass.center;
+            mass.I += fixture_mass.I;
         }
+        if (mass.mass > 0.0f)
+            mass.center *= 1.0f / mass.mass;
+
+        defs.fixture_counts.push_back(fixture_count);
+        defs.masses.push_back(mass);
+        fixture_masses.shrink(0);
     }
 
-    // /*test return*/ return;
+    // shapes stay in place from here on
+    for (uint32_t f = 0; f < defs.fixtures.size(); ++f)
+        defs.fixtures[f].shape = std::visit([]<typename T>(T &b2s) -> b2Shape *
+                                            { if constexpr (std::is_same_v<T, std::monostate>) return nullptr; else return &b2s; },
+                                            defs.shapes[f]);
+}
 
-    /*joint*/
-    auto &world_joint_list = world_dict.at<CKList>(db2Key::JOINT);
-    if (world_joint_list != nullval)
+auto db2Decoder::Create_Bodies(dotBox2d &db2, BodyDefs &defs, db2DynArray<b2Body *> &disabled) -> void
+{
+    auto &dicts = db2.chunks.at<CKDict>();
+
+    uint32_t f = 0;
+    for (uint32_t b = 0; b < defs.bodies.size(); ++b)
     {
-        for (auto j = 0; j < world_joint_list.size(); ++j)
+        // a disabled body has no broadphase proxies, they are inserted by Enable_Bodies
+        auto enabled = defs.bodies[b].enabled;
+        defs.bodies[b].enabled = false;
+
+        auto p_b2b = db2.p_b2w->CreateBody(&defs.bodies[b]);
+        if (enabled)
+            disabled.push_back(p_b2b);
+
+        auto &body_dict = dicts.at(defs.bodies[b].userData.pointer);
+        if (body_dict != nullval)
+            /*.userData*/ body_dict.runtime = p_b2b;
+
+        // fixtures are created massless, since Box2D resets the mass data of the body for each fixture
+        // of density otherwise, and the mass summed by Decode_Bodies is set once
+        auto massive = false;
+        for (auto end = f + defs.fixture_counts[b]; f < end; ++f)
         {
-            auto &joint_dict = world_joint_list.at<CKDict>(j);
-            auto &db2j = joint_dict.at<CKJoint>(db2Key::Base);
+            auto &b2fdef = defs.fixtures[f];
+            auto density = b2fdef.density;
+            b2fdef.density = 0.0f;
 
-            b2JointDef *p_b2jdef{nullptr};
-            db2Decoder::Decode_Joint(db2j, p_b2jdef);
+            auto p_b2f = p_b2b->CreateFixture(&b2fdef);
+            p_b2f->SetDensity(density);
+            massive |= density > 0.0f;
 
-            if (db2j.type3() != b2JointType::e_gearJoint)
-            {
-                auto &joint_body_list = joint_dict.at<CKList>(db2Key::BODY);
-                p_b2jdef->bodyA = (b2Body *)joint_body_list.at<CKDict>(0).runtime;
-                p_b2jdef->bodyB = (b2Body *)joint_body_list.at<CKDict>(1).runtime;
-            }
-            else
-            {
-                auto &joint_joint_list = joint_dict.at<CKList>(db2Key::JOINT);
-                ((b2GearJointDef *)p_b2jdef)->joint1 = (b2Joint *)joint_joint_list.at<CKDict>(0).runtime;
-                ((b2GearJointDef *)p_b2jdef)->joint2 = (b2Joint *)joint_joint_list.at<CKDict>(1).runtime;
-            }
+            auto &fixture_dict = dicts.at(b2fdef.userData.pointer);
+            if (fixture_dict != nullval)
+                /*.userData*/ fixture_dict.runtime = p_b2f;
+        }
 
-            /*userData*/ p_b2jdef->userData.pointer = (uintptr_t)world_joint_list.ref<CKDict>(j);
-            /*.userData*/ joint_dict.runtime = db2.p_b2w->CreateJoint(p_b2jdef);
-            if (p_b2jdef)
-                delete p_b2jdef;
+        if (massive && p_b2b->GetType() == b2_dynamicBody)
+        {
+            if (defs.masses[b].mass > 0.0f)
+                p_b2b->SetMassData(&defs.masses[b]);
+            else // of massless shapes only, left to Box2D, which falls back to a unit mass its own way
+                p_b2b->ResetMassData();
         }
     }
 }
 
+auto db2Decoder::Enable_Bodies(db2DynArray<b2Body *> &bodies) -> void
+{
+    // proxies are inserted along a Z-order curve over the bodies, so neighbouring leaves of the
+    // dynamic tree are inserted in turn, rather than in file order
+    db2Decoder::Sort_Bodies(bodies);
+    for (uint32_t b = 0; b < bodies.size(); ++b)
+        bodies[b]->SetEnabled(true);
+}
+
+auto db2Decoder::Sort_Bodies(db2DynArray<b2Body *> &bodies) -> void
+{
+    if (bodies.size() == 0)
+        return;
+
+    auto lower = bodies[0]->GetPosition();
+    auto upper = lower;
+    for (uint32_t b = 1; b < bodies.size(); ++b)
+    {
+        lower = b2Min(lower, bodies[b]->GetPosition());
+        upper = b2Max(upper, bodies[b]->GetPosition());
+    }
+    auto scale_x = upper.x > lower.x ? 65535.0f / (upper.x - lower.x) : 0.0f;
+    auto scale_y = upper.y > lower.y ? 65535.0f / (upper.y - lower.y) : 0.0f;
+
+    struct Item
+    {
+        uint32_t code;
+        b2Body *p_b2b;
+    };
+
+    db2DynArray<Item> items{};
+    items.reserve(bodies.size(), false);
+    for (uint32_t b = 0; b < bodies.size(); ++b)
+    {
+        auto &position = bodies[b]->GetPosition();
+        auto x = uint32_t((position.x - lower.x) * scale_x);
+        auto y = uint32_t((position.y - lower.y) * scale_y);
+        items.push_back(Item{db2Decoder::Morton(x) | (db2Decoder::Morton(y) << 1), bodies[b]});
+    }
+    std::stable_sort(items.data, items.data + items.size(), [](const Item &a, const Item &b)
+                     { return a.code < b.code; }); // bodies of a code stay in list order
+
+    for (uint32_t i = 0; i < items.size(); ++i)
+        bodies[i] = items[i].p_b2b;
+}
+
+auto db2Decoder::Morton(uint32_t x) -> uint32_t
+{
+    x &= 0x0000FFFF;
+    x = (x | (x << 8)) & 0x00FF00FF;
+    x = (x | (x << 4)) & 0x0F0F0F0F;
+    x = (x | (x << 2)) & 0x33333333;
+    x = (x | (x << 1)) & 0x55555555;
+    return x;
+}
+
+auto db2Decoder::Create_Joint(dotBox2d &db2, CKDict &dicts, db2List &joint_list, const uint32_t j, db2JointView &joint) -> b2Joint *
+{
+    auto &joint_dict = dicts.at(joint_list[j]);
+    if (joint_dict == nullval)
+        return nullptr;
+
+    joint.bind(joint_dict);
+    auto &db2j = joint.base();
+
+    // bodyA and bodyB, or joint1 and joint2 of gear joints
+    auto gear = db2j.type3() == b2JointType::e_gearJoint;
+    auto &links = gear ? joint.joints() : joint.bodies();
+    if (links == nullval || links.size() < 2)
+        return nullptr;
+
+    auto &dict0 = dicts.at(links[0]);
+    auto &dict1 = dicts.at(links[1]);
+    if (dict0 == nullval || dict1 == nullval || !dict0.runtime || !dict1.runtime)
+        return nullptr; // not created yet
+
+    JointDef b2jdef{};
+    auto p_b2jdef = db2Decoder::Decode_Joint(db2j, b2jdef);
+    if (!p_b2jdef)
+        return nullptr;
+
+    if (!gear)
+    {
+        p_b2jdef->bodyA = (b2Body *)dict0.runtime;
+        p_b2jdef->bodyB = (b2Body *)dict1.runtime;
+    }
+    else
+    {
+        ((b2GearJointDef *)p_b2jdef)->joint1 = (b2Joint *)dict0.runtime;
+        ((b2GearJointDef *)p_b2jdef)->joint2 = (b2Joint *)dict1.runtime;
+    }
+
+    /*userData*/ p_b2jdef->userData.pointer = (uintptr_t)joint_list[j];
+    auto p_b2j = db2.p_b2w->CreateJoint(p_b2jdef);
+    /*.userData*/ joint_dict.runtime = p_b2j;
+    return p_b2j;
+}
+
 auto db2Decoder::Decode_World(db2World &db2w, b2Vec2 &gravity) -> void
 {
     gravity.x = db2w.gravity_x;
@@ -143,50 +379,28 @@ auto db2Decoder::Decode_Fixture(db2Fixture &db2f, b2FixtureDef &b2fdef) -> void
     b2fdef.filter.groupIndex = db2f.filter_groupIndex;
 }
 
-auto db2Decoder::Decode_Shpae(db2Shape &db2s, b2Shape *&p_b2s) -> void
+auto db2Decoder::Decode_Shpae(db2Shape &db2s, Shape &b2s, db2Derived *p_db2d) -> b2Shape *
 {
     static_assert(sizeof(b2Vec2) == 8);
 
+    b2Shape *p_b2s = nullptr;
+
     switch ((b2Shape::Type)db2s.type3())
     {
 
     case b2Shape::Type::e_circle:
-    {
-        assert(db2s.size() == 1 + 2);
-
-        p_b2s = new b2CircleShape();
-        auto &b2s_t = *(b2CircleShape *)p_b2s;
-
-        int32_t i = 0;
-        b2s_t.m_radius = db2s[i++]; // default: b2_polygonRadius
-
-        b2s_t.m_p = {db2s[i++], db2s[i++]};
-    }
-    break;
+        p_b2s = db2Decoder::Decode_Shpae<db2CircleShapeCodec>(db2s, b2s);
+        break;
 
     case b2Shape::e_edge:
-    {
-        assert(db2s.size() == 1 + 9);
-
-        p_b2s = new b2EdgeShape();
-        auto &b2s_t = *(b2EdgeShape *)p_b2s;
-
-        int32_t i = 0;
-        b2s_t.m_radius = db2s[i++]; // default: b2_polygonRadius
-
-        b2s_t.m_vertex0 = {db2s[i++], db2s[i++]};
-        b2s_t.m_vertex1 = {db2s[i++], db2s[i++]};
-        b2s_t.m_vertex2 = {db2s[i++], db2s[i++]};
-        b2s_t.m_vertex3 = {db2s[i++], db2s[i++]};
-        b2s_t.m_oneSided = (bool)db2s[i++];
-    }
-    break;
+        p_b2s = db2Decoder::Decode_Shpae<db2EdgeShapeCodec>(db2s, b2s);
+        break;
 
     case b2Shape::e_polygon:
     {
         assert(db2s.size() >= 1 + 6);
 
-        p_b2s = new b2PolygonShape();
+        p_b2s = &b2s.emplace<b2PolygonShape>();
         auto &b2s_t = *(b2PolygonShape *)p_b2s;
 
         int32_t i = 0;
@@ -194,7 +408,18 @@ auto db2Decoder::Decode_Shpae(db2Shape &db2s, b2Shape *&p_b2s) -> void
 
         auto points = (b2Vec2 *)(&(db2s[i])); // !
         auto count = (db2s.size() - 1) / 2;
-        b2s_t.Set(points, count);
+        if (p_db2d && p_db2d->type3() == b2Shape::e_polygon && p_db2d->size() == 7 + count * 2 && count <= b2_maxPolygonVertices)
+        {
+            // the vertices were written from a hull computed by Set, which would compute the same one
+            b2s_t.m_count = count;
+            std::memcpy(b2s_t.m_vertices, points, count * sizeof(b2Vec2));
+            b2s_t.m_centroid = {(*p_db2d)[5], (*p_db2d)[6]};
+            std::memcpy(b2s_t.m_normals, &(*p_db2d)[7], count * sizeof(b2Vec2));
+        }
+        else
+        {
+            b2s_t.Set(points, count);
+        }
     }
     break;
 
@@ -202,7 +427,7 @@ auto db2Decoder::Decode_Shpae(db2Shape &db2s, b2Shape *&p_b2s) -> void
     {
         assert(db2s.size() >= 1 + 8);
 
-        p_b2s = new b2ChainShape();
+        p_b2s = &b2s.emplace<b2ChainShape>();
         auto &b2s_t = *(b2ChainShape *)p_b2s;
 
         int32_t i = 0;
@@ -223,318 +448,560 @@ auto db2Decoder::Decode_Shpae(db2Shape &db2s, b2Shape *&p_b2s) -> void
     }
     break;
     }
+
+    return p_b2s;
 }
 
-auto db2Decoder::Decode_Joint(db2Joint &db2j, b2JointDef *&p_b2jdef) -> void
+template <typename Codec>
+auto db2Decoder::Decode_Shpae(db2Shape &db2s, Shape &b2s) -> b2Shape *
 {
-    int32_t p = 0;
+    assert(db2s.size() == 1 + Codec::count);
 
+    auto &b2s_t = b2s.template emplace<typename Codec::def_type>();
+    b2s_t.m_radius = db2s[0]; // default: b2_polygonRadius
+    Codec::Decode(&db2s[1], b2s_t);
+    return &b2s_t;
+}
+
+auto db2Decoder::Decode_Joint(db2Joint &db2j, JointDef &b2jdef) -> b2JointDef *
+{
+    // the fields of each type are listed by its codec, see db2_codec.h
     switch (b2JointType(db2j.type3()))
     {
     case b2JointType::e_revoluteJoint:
-    {
-        p_b2jdef = new b2RevoluteJointDef();
-        auto &b2jdef_t = *(b2RevoluteJointDef *)p_b2jdef;
-
-        b2jdef_t.collideConnected = (bool)db2j[p++];
+        return db2Decoder::Decode_Joint<db2RevoluteJointCodec>(db2j, b2jdef);
 
-        assert(db2j.size() == 1 + 11);
+    case b2JointType::e_prismaticJoint:
+        return db2Decoder::Decode_Joint<db2PrismaticJointCodec>(db2j, b2jdef);
 
-        b2jdef_t.localAnchorA = {db2j[p++], db2j[p++]};
-        b2jdef_t.localAnchorB = {db2j[p++], db2j[p++]};
-        b2jdef_t.referenceAngle = db2j[p++];
-        b2jdef_t.enableLimit = (bool)db2j[p++];
-        b2jdef_t.lowerAngle = db2j[p++];
-        b2jdef_t.upperAngle = db2j[p++];
-        b2jdef_t.enableMotor = (bool)db2j[p++];
-        b2jdef_t.motorSpeed = db2j[p++];
-        b2jdef_t.maxMotorTorque = db2j[p++];
-    }
-    break;
+    case b2JointType::e_distanceJoint:
+        return db2Decoder::Decode_Joint<db2DistanceJointCodec>(db2j, b2jdef);
 
-    case b2JointType::e_prismaticJoint:
-    {
-        p_b2jdef = new b2PrismaticJointDef();
-        auto &b2jdef_t = *(b2PrismaticJointDef *)p_b2jdef;
+    case b2JointType::e_pulleyJoint:
+        return db2Decoder::Decode_Joint<db2PulleyJointCodec>(db2j, b2jdef);
 
-        b2jdef_t.collideConnected = (bool)db2j[p++];
+    case b2JointType::e_mouseJoint:
+        return db2Decoder::Decode_Joint<db2MouseJointCodec>(db2j, b2jdef);
 
-        assert(db2j.size() == 1 + 13);
+    case b2JointType::e_gearJoint:
+        return db2Decoder::Decode_Joint<db2GearJointCodec>(db2j, b2jdef);
 
-        b2jdef_t.localAnchorA = {db2j[p++], db2j[p++]};
-        b2jdef_t.localAnchorB = {db2j[p++], db2j[p++]};
-        b2jdef_t.localAxisA = {db2j[p++], db2j[p++]};
-        b2jdef_t.referenceAngle = db2j[p++];
-        b2jdef_t.enableLimit = (bool)db2j[p++];
-        b2jdef_t.lowerTranslation = db2j[p++];
-        b2jdef_t.upperTranslation = db2j[p++];
-        b2jdef_t.enableMotor = (bool)db2j[p++];
-        b2jdef_t.maxMotorForce = db2j[p++];
-        b2jdef_t.motorSpeed = db2j[p++];
-    }
-    break;
+    case b2JointType::e_wheelJoint:
+        return db2Decoder::Decode_Joint<db2WheelJointCodec>(db2j, b2jdef);
 
-    case b2JointType::e_distanceJoint:
-    {
-        p_b2jdef = new b2DistanceJointDef();
-        auto &b2jdef_t = *(b2DistanceJointDef *)p_b2jdef;
+    case b2JointType::e_weldJoint:
+        return db2Decoder::Decode_Joint<db2WeldJointCodec>(db2j, b2jdef);
 
-        b2jdef_t.collideConnected = (bool)db2j[p++];
+    case b2JointType::e_frictionJoint:
+        return db2Decoder::Decode_Joint<db2FrictionJointCodec>(db2j, b2jdef);
 
-        assert(db2j.size() == 1 + 9);
+    case b2JointType::e_motorJoint:
+        return db2Decoder::Decode_Joint<db2MotorJointCodec>(db2j, b2jdef);
 
-        b2jdef_t.localAnchorA = {db2j[p++], db2j[p++]};
-        b2jdef_t.localAnchorB = {db2j[p++], db2j[p++]};
-        b2jdef_t.length = db2j[p++];
-        b2jdef_t.minLength = db2j[p++];
-        b2jdef_t.maxLength = db2j[p++];
-        b2jdef_t.stiffness = db2j[p++];
-        b2jdef_t.damping = db2j[p++];
+    case b2JointType::e_ropeJoint: // b2RopeJointDef
+    default:
+        return nullptr;
     }
-    break;
+}
 
-    case b2JointType::e_pulleyJoint:
-    {
-        p_b2jdef = new b2PulleyJointDef();
-        auto &b2jdef_t = *(b2PulleyJointDef *)p_b2jdef;
+template <typename Codec>
+auto db2Decoder::Decode_Joint(db2Joint &db2j, JointDef &b2jdef) -> b2JointDef *
+{
+    assert(db2j.size() == 1 + Codec::count);
 
-        b2jdef_t.collideConnected = (bool)db2j[p++];
+    auto &b2jdef_t = b2jdef.template emplace<typename Codec::def_type>();
+    b2jdef_t.collideConnected = (bool)db2j[0];
+    Codec::Decode(&db2j[1], b2jdef_t);
+    return &b2jdef_t;
+}
 
-        assert(db2j.size() == 1 + 11);
+auto db2Decoder::Hash_Derived(db2Fixture &db2f, db2Shape &db2s) -> uint32_t
+{
+    // over the bits of values, which are kept across endianness; a single edited value always changes it
+    auto hash = db2HashIndex::Hash(db2s.type3());
+    hash = db2HashIndex::Combine(hash, std::bit_cast<uint32_t>(db2f.density));
+    for (uint32_t i = 0; i < db2s.size(); ++i)
+        hash = db2HashIndex::Combine(hash, std::bit_cast<uint32_t>(db2s[i]));
+    return hash;
+}
 
-        b2jdef_t.groundAnchorA = {db2j[p++], db2j[p++]};
-        b2jdef_t.groundAnchorB = {db2j[p++], db2j[p++]};
-        b2jdef_t.localAnchorA = {db2j[p++], db2j[p++]};
-        b2jdef_t.localAnchorB = {db2j[p++], db2j[p++]};
-        b2jdef_t.lengthA = db2j[p++];
-        b2jdef_t.lengthB = db2j[p++];
-        b2jdef_t.ratio = db2j[p++];
-    }
-    break;
+auto db2Decoder::Encode(dotBox2d &db2, const bool withDerived) -> void
+{
+    if (!db2.p_b2w)
+        return;
 
-    case b2JointType::e_mouseJoint:
-    {
-        p_b2jdef = new b2MouseJointDef();
-        auto &b2jdef_t = *(b2MouseJointDef *)p_b2jdef;
+    // a document which has a world already is updated
+    if (db2.chunks.at<CKDict>() != nullval)
+        if (auto world_dict_i = db2.world_dict_i(); world_dict_i != UINT32_MAX)
+            return db2Decoder::Reencode(db2, world_dict_i, withDerived);
 
-        b2jdef_t.collideConnected = (bool)db2j[p++];
+    /*
+    Box2D prepends objects on creation, so its lists are in reverse file order. They are walked
+    as they are, and objects are placed from the end of their blocks, so nothing is collected.
+    */
+    uint32_t body_count = db2.p_b2w->GetBodyCount();
+    uint32_t joint_count = db2.p_b2w->GetJointCount();
+    uint32_t fixture_count = 0;
+    uint32_t fixture_list_count = 0;             // bodies with fixtures
+    db2DynArray<uint32_t> body_fixture_counts{}; // of each body in list order, for the second pass
+    body_fixture_counts.reserve(body_count, false);
+    for (auto p_b2b = db2.p_b2w->GetBodyList(); p_b2b; p_b2b = p_b2b->GetNext())
+    {
+        auto count = body_fixture_counts.emplace_back(db2Decoder::Count(p_b2b->GetFixtureList()));
+        fixture_count += count;
+        fixture_list_count += count > 0;
+    }
 
-        assert(db2j.size() == 1 + 5);
+    // every pool grows once, and dicts are laid out as: info, world, (body, fixtures of body)..., joints
+    db2Builder builder{db2.chunks};
 
-        b2jdef_t.target = {db2j[p++], db2j[p++]};
-        b2jdef_t.maxForce = db2j[p++];
-        b2jdef_t.stiffness = db2j[p++];
-        b2jdef_t.damping = db2j[p++];
-    }
-    break;
+    auto info_dict_i = builder.append<CKDict>(2 + body_count + fixture_count + joint_count);
+    auto world_dict_i = info_dict_i + 1;
+    auto joint_dict_i = world_dict_i + 1 + body_count + fixture_count;
 
-    case b2JointType::e_gearJoint:
-    {
-        p_b2jdef = new b2GearJointDef();
-        auto &b2jdef_t = *(b2GearJointDef *)p_b2jdef;
+    auto info_i = builder.append<CKInfo>(1);
+    auto world_i = builder.append<CKWorld>(1);
+    auto body_i = builder.append<CKBody>(body_count);
+    auto fixture_i = builder.append<CKFixture>(fixture_count);
+    auto shape_i = builder.append<CKShape>(fixture_count);
+    auto joint_i = builder.append<CKJoint>(joint_count);
+    auto derived_i = builder.append<CKDerived>(withDerived ? fixture_count : 0);
 
-        b2jdef_t.collideConnected = (bool)db2j[p++];
+    // lists: bodies and joints of the world, fixtures of each body, bodies (or joints) of each joint
+    auto list_i = builder.append<CKList>((body_count > 0) + (joint_count > 0) + fixture_list_count + joint_count);
+    auto fixture_list_i = list_i + (body_count > 0) + (joint_count > 0);
+    auto joint_list_i = fixture_list_i + fixture_list_count;
 
-        assert(db2j.size() == 1 + 1);
+    auto &dicts = builder.pool<CKDict>();
 
-        // b2jdef_t.joint1;
-        // b2jdef_t.joint2;
-        b2jdef_t.ratio = db2j[p++];
+    // info
+    {
+        auto &info = dicts[info_dict_i];
+        db2Builder::Link<CKInfo>(info, db2Key::Base, info_i);
     }
-    break;
 
-    case b2JointType::e_wheelJoint:
+    // world
+    db2List *p_world_body_list = nullptr;
+    uint32_t world_body_first = 0;
     {
-        p_b2jdef = new b2WheelJointDef();
-        auto &b2jdef_t = *(b2WheelJointDef *)p_b2jdef;
+        auto &world_dict = dicts[world_dict_i];
+        world_dict.reserve(3, false);
+        db2Builder::Link<CKWorld>(world_dict, db2Key::Base, world_i);
+        db2Decoder::Encode_World(*db2.p_b2w, builder.pool<CKWorld>()[world_i]);
 
-        b2jdef_t.collideConnected = (bool)db2j[p++];
-
-        assert(db2j.size() == 1 + 14);
+        if (body_count > 0)
+        {
+            db2Builder::Link<CKList>(world_dict, db2Key::BODY, list_i);
+            p_world_body_list = &builder.pool<CKList>()[list_i++];
+            world_body_first = db2Builder::Expand<CKDict>(*p_world_body_list, body_count);
+        }
 
-        b2jdef_t.localAnchorA = {db2j[p++], db2j[p++]};
-        b2jdef_t.localAnchorB = {db2j[p++], db2j[p++]};
-        b2jdef_t.localAxisA = {db2j[p++], db2j[p++]};
-        b2jdef_t.enableLimit = (bool)db2j[p++];
-        b2jdef_t.lowerTranslation = db2j[p++];
-        b2jdef_t.upperTranslation = db2j[p++];
-        b2jdef_t.enableMotor = (bool)db2j[p++];
-        b2jdef_t.maxMotorTorque = db2j[p++];
-        b2jdef_t.motorSpeed = db2j[p++];
-        b2jdef_t.stiffness = db2j[p++];
-        b2jdef_t.damping = db2j[p++];
+        if (joint_count > 0)
+        {
+            db2Builder::Link<CKList>(world_dict, db2Key::JOINT, list_i);
+            db2Builder::Link<CKDict>(builder.pool<CKList>()[list_i++], joint_dict_i, joint_count);
+        }
     }
-    break;
 
-    case b2JointType::e_weldJoint:
+    /*body*/ // from the last one, which is followed by the joint dicts
+    auto b = body_count;
+    auto f_end = fixture_count; // fixtures of the bodies after b
+    auto dict_end = joint_dict_i;
+    auto fixture_list_end = joint_list_i;
+    for (auto p_b2b = db2.p_b2w->GetBodyList(); p_b2b; p_b2b = p_b2b->GetNext())
     {
-        p_b2jdef = new b2WeldJointDef();
-        auto &b2jdef_t = *(b2WeldJointDef *)p_b2jdef;
+        --b;
+        auto count = body_fixture_counts[body_count - 1 - b];
+        auto body_dict_i = dict_end - 1 - count;
+        dict_end = body_dict_i;
 
-        b2jdef_t.collideConnected = (bool)db2j[p++];
+        /*.userData*/ dicts[body_dict_i].runtime = p_b2b;
+        /*userData*/ p_b2b->GetUserData().pointer = (uintptr_t)body_dict_i;
+        (*p_world_body_list)[world_body_first + b] = body_dict_i;
 
-        assert(db2j.size() == 1 + 7);
+        auto &body_dict = dicts[body_dict_i];
+        body_dict.reserve(2, false);
+        db2Builder::Link<CKBody>(body_dict, db2Key::Base, body_i + b);
+        db2Decoder::Encode_Body(*p_b2b, builder.pool<CKBody>()[body_i + b]);
 
-        b2jdef_t.localAnchorA = {db2j[p++], db2j[p++]};
-        b2jdef_t.localAnchorB = {db2j[p++], db2j[p++]};
-        b2jdef_t.referenceAngle = db2j[p++];
-        b2jdef_t.stiffness = db2j[p++];
-        b2jdef_t.damping = db2j[p++];
-    }
-    break;
+        /*fixture*/
+        if (count == 0)
+            continue;
 
-    case b2JointType::e_frictionJoint:
-    {
-        p_b2jdef = new b2FrictionJointDef();
-        auto &b2jdef_t = *(b2FrictionJointDef *)p_b2jdef;
+        db2Builder::Link<CKList>(body_dict, db2Key::FIXTURE, --fixture_list_end);
+        db2Builder::Link<CKDict>(builder.pool<CKList>()[fixture_list_end], body_dict_i + 1, count);
 
-        b2jdef_t.collideConnected = (bool)db2j[p++];
+        auto fixture_dict_i = body_dict_i + 1 + count;
+        for (auto p_b2f = p_b2b->GetFixtureList(); p_b2f; p_b2f = p_b2f->GetNext())
+        {
+            auto f = --f_end;
+            --fixture_dict_i;
 
-        assert(db2j.size() == 1 + 6);
+            /*.userData*/ dicts[fixture_dict_i].runtime = p_b2f;
+            /*userData*/ p_b2f->GetUserData().pointer = (uintptr_t)fixture_dict_i;
 
-        b2jdef_t.localAnchorA = {db2j[p++], db2j[p++]};
-        b2jdef_t.localAnchorB = {db2j[p++], db2j[p++]};
-        b2jdef_t.maxForce = db2j[p++];
-        b2jdef_t.maxTorque = db2j[p++];
+            db2Decoder::Encode_Fixture_Dict(builder, fixture_dict_i, *p_b2f, fixture_i + f, shape_i + f, withDerived ? derived_i + f : UINT32_MAX);
+        }
     }
-    break;
 
-    case b2JointType::e_ropeJoint:
+    /*joint*/
+    // userData before writing any link, since links to joints could point forwards (gear joints)
+    auto j = joint_count;
+    for (auto p_b2j = db2.p_b2w->GetJointList(); p_b2j; p_b2j = p_b2j->GetNext())
     {
-        // b2RopeJointDef b2jdef;
+        --j;
+        /*.userData*/ dicts[joint_dict_i + j].runtime = p_b2j;
+        /*userData*/ p_b2j->GetUserData().pointer = (uintptr_t)(joint_dict_i + j);
     }
-    break;
 
-    case b2JointType::e_motorJoint:
+    j = joint_count;
+    for (auto p_b2j = db2.p_b2w->GetJointList(); p_b2j; p_b2j = p_b2j->GetNext())
     {
-        p_b2jdef = new b2MotorJointDef();
-        auto &b2jdef_t = *(b2MotorJointDef *)p_b2jdef;
-
-        b2jdef_t.collideConnected = (bool)db2j[p++];
-
-        assert(db2j.size() == 1 + 6);
-
-        b2jdef_t.linearOffset = {db2j[p++], db2j[p++]};
-        b2jdef_t.angularOffset = db2j[p++];
-        b2jdef_t.maxForce = db2j[p++];
-        b2jdef_t.maxTorque = db2j[p++];
-        b2jdef_t.correctionFactor = db2j[p++];
+        --j;
+        db2Decoder::Encode_Joint_Dict(builder, joint_dict_i + j, *p_b2j, joint_i + j, joint_list_i + j);
     }
-    break;
 
-    default:
-        break;
-    }
+    builder.finish();
 }
 
-auto db2Decoder::Encode(dotBox2d &db2) -> void
+auto db2Decoder::Encode_Fixture_Dict(db2Builder &builder, const uint32_t fixture_dict_i, b2Fixture &b2f, const uint32_t fixture_i, const uint32_t shape_i, const uint32_t derived_i) -> void
 {
-    if (!db2.p_b2w)
-        return;
+    auto &fixture_dict = builder.pool<CKDict>()[fixture_dict_i];
+    fixture_dict.reserve(derived_i != UINT32_MAX ? 3 : 2, false);
 
-    auto &dicts = db2.chunks.get<CKDict>();
+    auto &db2f = builder.pool<CKFixture>()[fixture_i];
+    db2Builder::Link<CKFixture>(fixture_dict, db2Key::Base, fixture_i);
+    db2Decoder::Encode_Fixture(b2f, db2f);
 
-    // info
+    /*shape*/
+    auto &db2s = builder.pool<CKShape>()[shape_i];
+    db2Builder::Link<CKShape>(fixture_dict, db2Key::SHAPE, shape_i);
+    db2Decoder::Encode_Shpae(*b2f.GetShape(), db2s);
+
+    /*derived*/
+    if (derived_i != UINT32_MAX)
     {
-        // constructs an element in-place at the end
-        auto &info = dicts.emplace_back();
-        info.emplace<CKInfo>(db2Key::Base);
+        db2Builder::Link<CKDerived>(fixture_dict, db2Key::Derived, derived_i);
+        db2Decoder::Encode_Derived(b2f, db2Decoder::Hash_Derived(db2f, db2s), builder.pool<CKDerived>()[derived_i]);
     }
+}
 
-    // world
-    auto world_dict_i = dicts.size();
+auto db2Decoder::Encode_Joint_Dict(db2Builder &builder, const uint32_t joint_dict_i, b2Joint &b2j, const uint32_t joint_i, const uint32_t list_i) -> void
+{
+    auto &joint_dict = builder.pool<CKDict>()[joint_dict_i];
+    joint_dict.reserve(2, false);
+    db2Builder::Link<CKJoint>(joint_dict, db2Key::Base, joint_i);
+    db2Decoder::Encode_Joint(b2j, builder.pool<CKJoint>()[joint_i]);
+
+    // bodies and joints are linked by their dicts
+    auto &joint_list = builder.pool<CKList>()[list_i];
+    joint_list.reserve(2, false);
+    if (b2j.GetType() != b2JointType::e_gearJoint)
+    {
+        db2Builder::Link<CKList>(joint_dict, db2Key::BODY, list_i);
+        /*bodyA*/ db2Builder::Link<CKDict>(joint_list, b2j.GetBodyA()->GetUserData().pointer, 1);
+        /*bodyB*/ db2Builder::Link<CKDict>(joint_list, b2j.GetBodyB()->GetUserData().pointer, 1);
+    }
+    else
     {
-        auto &world_dict = dicts.emplace_back();
-        auto &db2w = world_dict.emplace<CKWorld>(db2Key::Base);
-        db2Decoder::Encode_World(*db2.p_b2w, db2w);
+        db2Builder::Link<CKList>(joint_dict, db2Key::JOINT, list_i);
+        /*joint1*/ db2Builder::Link<CKDict>(joint_list, ((b2GearJoint &)b2j).GetJoint1()->GetUserData().pointer, 1);
+        /*joint2*/ db2Builder::Link<CKDict>(joint_list, ((b2GearJoint &)b2j).GetJoint2()->GetUserData().pointer, 1);
     }
+}
+
+auto db2Decoder::Reencode(dotBox2d &db2, const uint32_t world_dict_i, const bool withDerived) -> void
+{
+    db2Builder builder{db2.chunks};
 
-    /*body*/
-    db2DynArray<b2Body *> bodies{};
-    bodies.reserve(db2.p_b2w->GetBodyCount(), false);
+    // values and runtimes are written in place, so pools shared with forks are copied first
+    auto &dicts = builder.pool<CKDict>();
+    dicts.detach();
+    auto detach = [](auto &pool)
+    {
+        if (pool != nullval)
+            pool.detach();
+    };
+    detach(db2.chunks.at<CKWorld>());
+    detach(db2.chunks.at<CKBody>());
+    detach(db2.chunks.at<CKFixture>());
+    detach(db2.chunks.at<CKList>());
+
+    db2WorldView world{};
+    world.bind(dicts[world_dict_i]);
+    db2Decoder::Encode_World(*db2.p_b2w, world.base());
+
+    /*body*/ // mapped bodies have their values overwritten, and their fixtures if the same ones are attached
+    db2BodyView body{};
+    auto body_list_i = world.find<1>() != nullval ? world.find<1>() : UINT32_MAX; // kept by index, pools could be reallocated
+    uint32_t listed = body_list_i != UINT32_MAX ? world.bodies().size() : 0;
+    uint32_t mapped = 0;
+    db2DynArray<b2Body *> refitted{}; // mapped bodies whose fixtures were added or destroyed
     for (auto p_b2b = db2.p_b2w->GetBodyList(); p_b2b; p_b2b = p_b2b->GetNext())
-        bodies.push_back(p_b2b);
+    {
+        if (db2Decoder::Is_Mapped(dicts, p_b2b) && body.bind(dicts[p_b2b->GetUserData().pointer]))
+        {
+            ++mapped, db2Decoder::Encode_Body(*p_b2b, body.base());
+            if (!db2Decoder::Overwrite_Fixtures(dicts, *p_b2b, body.fixtures(), db2Decoder::Count(p_b2b->GetFixtureList())))
+                refitted.push_back(p_b2b);
+        }
+    }
+    auto added = db2.p_b2w->GetBodyCount() - mapped;
+    auto edited = added > 0 || mapped != listed || refitted.size() > 0; // links are only rebuilt if lists were edited
 
-    for (int b = bodies.size() - 1; b >= 0; --b) // reverse order
+    if (mapped != listed) // bodies were destroyed
+        db2Decoder::Unlist(dicts, world.bodies(), db2.p_b2w->GetBodyList());
+
+    // fixtures are encoded again as new ones, and the dicts of the old ones are left unreachable
+    for (uint32_t r = 0; r < refitted.size(); ++r)
     {
-        auto p_b2b = bodies[b];
+        auto p_b2b = refitted[r];
+        auto body_dict_i = p_b2b->GetUserData().pointer;
+        body.bind(builder.pool<CKDict>()[body_dict_i]);
+        auto fixture_list_i = body.find<1>() != nullval ? body.find<1>() : UINT32_MAX;
+        if (fixture_list_i != UINT32_MAX)
+        {
+            auto &fixture_list = body.fixtures();
+            for (uint32_t f = 0; f < fixture_list.size(); ++f)
+                if (auto &fixture_dict = dicts.at(fixture_list[f]); fixture_dict != nullval)
+                    fixture_dict.runtime = nullptr; // the fixture could be destroyed
+        }
 
-        auto body_dict_i = dicts.size();
+        auto count = db2Decoder::Count(p_b2b->GetFixtureList());
+        auto fixture_dict_i = builder.append<CKDict>(count);
+        db2Decoder::Encode_Fixture_Dicts(builder, *p_b2b, fixture_dict_i, count, withDerived);
+
+        if (fixture_list_i == UINT32_MAX)
         {
-            auto &world_body_list = dicts[world_dict_i].get<CKList>(db2Key::BODY);
-            auto &body_dict = world_body_list.emplace_back<CKDict>();
-            auto &db2b = body_dict.emplace<CKBody>(db2Key::Base);
-            db2Decoder::Encode_Body(*p_b2b, db2b);
+            if (count == 0)
+                continue;
+            fixture_list_i = builder.append<CKList>(1);
+            builder.pool<CKDict>()[body_dict_i].link<CKList>(db2Key::FIXTURE, fixture_list_i);
+        }
+        auto &fixture_list = builder.pool<CKList>()[fixture_list_i];
+        fixture_list.shrink(0);
+        db2Builder::Link<CKDict>(fixture_list, fixture_dict_i, count);
+    }
+    world.bind(builder.pool<CKDict>()[world_dict_i]); // could have been reallocated
 
-            /*.userData*/ body_dict.runtime = p_b2b;
-            /*userData*/ p_b2b->GetUserData().pointer = (uintptr_t)body_dict_i;
+    if (added > 0)
+    {
+        if (body_list_i == UINT32_MAX)
+        {
+            body_list_i = builder.append<CKList>(1);
+            dicts[world_dict_i].link<CKList>(db2Key::BODY, body_list_i);
         }
+        auto first = db2Builder::Expand<CKDict>(builder.pool<CKList>()[body_list_i], added);
 
-        /*fixture*/
-        db2DynArray<b2Fixture *> fixtures{};
-        // fixtures.reserve(b2b->GetFixtureCount(), false); // no way to get fixture count directly
-        for (auto p_b2f = p_b2b->GetFixtureList(); p_b2f; p_b2f = p_b2f->GetNext())
-            fixtures.push_back(p_b2f);
+        // new bodies lead Box2D's list, and are appended in the order of their creation
+        for (auto p_b2b = db2.p_b2w->GetBodyList(); p_b2b && added > 0; p_b2b = p_b2b->GetNext())
+            if (!db2Decoder::Is_Mapped(builder.pool<CKDict>(), p_b2b))
+                builder.pool<CKList>()[body_list_i][first + --added] = db2Decoder::Encode_New_Body(builder, *p_b2b, withDerived);
+    }
 
-        for (int f = fixtures.size() - 1; f >= 0; --f) // reverse order
+    /*joint*/ // mapped joints have their values overwritten, the objects they link are fixed by Box2D
+    auto &dicts_j = builder.pool<CKDict>(); // could have been reallocated
+    world.bind(dicts_j[world_dict_i]);
+
+    auto joint_list_i = world.find<2>() != nullval ? world.find<2>() : UINT32_MAX;
+    listed = joint_list_i != UINT32_MAX ? world.joints().size() : 0;
+    mapped = 0;
+    db2JointView joint{};
+    for (auto p_b2j = db2.p_b2w->GetJointList(); p_b2j; p_b2j = p_b2j->GetNext())
+        if (db2Decoder::Is_Mapped(dicts_j, p_b2j) && joint.bind(dicts_j[p_b2j->GetUserData().pointer]))
         {
-            auto p_b2f = fixtures[f];
+            ++mapped;
+            auto &db2j = joint.base();
+            db2j.shrink(0); // detached, then encoded again
+            db2Decoder::Encode_Joint(*p_b2j, db2j);
+        }
+    added = db2.p_b2w->GetJointCount() - mapped;
+    edited = edited || added > 0 || mapped != listed;
 
-            auto fixture_dict_i = dicts.size();
-            {
-                auto &body_fixture_list = dicts[body_dict_i].get<CKList>(db2Key::FIXTURE);
-                auto &fixture_dict = body_fixture_list.emplace_back<CKDict>();
-                auto &db2f = fixture_dict.emplace<CKFixture>(db2Key::Base);
+    if (mapped != listed) // joints were destroyed
+        db2Decoder::Unlist(dicts_j, world.joints(), db2.p_b2w->GetJointList());
 
-                db2Decoder::Encode_Fixture(*p_b2f, db2f);
+    if (added > 0)
+    {
+        if (joint_list_i == UINT32_MAX)
+        {
+            joint_list_i = builder.append<CKList>(1);
+            dicts_j[world_dict_i].link<CKList>(db2Key::JOINT, joint_list_i);
+        }
 
-                /*.userData*/ fixture_dict.runtime = p_b2f;
-                /*userData*/ p_b2f->GetUserData().pointer = (uintptr_t)fixture_dict_i;
-            }
+        auto joint_dict_i = builder.append<CKDict>(added);
+        auto joint_i = builder.append<CKJoint>(added);
+        auto list_i = builder.append<CKList>(added);
+        auto first = db2Builder::Expand<CKDict>(builder.pool<CKList>()[joint_list_i], added);
 
-            /*shape*/
-            {
-                auto p_b2s = p_b2f->GetShape();
-                auto &fixture_shape = dicts[fixture_dict_i].emplace<CKShape>(db2Key::SHAPE);
-                db2Decoder::Encode_Shpae(*p_b2s, fixture_shape);
-            }
+        // userData before writing any link, since links to joints could point forwards (gear joints)
+        auto &dicts_a = builder.pool<CKDict>();
+        auto j = added;
+        for (auto p_b2j = db2.p_b2w->GetJointList(); p_b2j && j > 0; p_b2j = p_b2j->GetNext())
+        {
+            if (db2Decoder::Is_Mapped(dicts_a, p_b2j))
+                continue;
+            --j;
+            /*.userData*/ dicts_a[joint_dict_i + j].runtime = p_b2j;
+            /*userData*/ p_b2j->GetUserData().pointer = (uintptr_t)(joint_dict_i + j);
+        }
+
+        for (auto p_b2j = db2.p_b2w->GetJointList(); p_b2j; p_b2j = p_b2j->GetNext())
+        {
+            auto d = p_b2j->GetUserData().pointer;
+            if (d < joint_dict_i || d >= joint_dict_i + added)
+                continue;
+            j = d - joint_dict_i;
+            db2Decoder::Encode_Joint_Dict(builder, d, *p_b2j, joint_i + j, list_i + j);
+            builder.pool<CKList>()[joint_list_i][first + j] = d;
         }
     }
 
-    /*joint*/
-    db2DynArray<b2Joint *> joints{};
-    joints.reserve(db2.p_b2w->GetJointCount(), false);
-    for (auto p_b2j = db2.p_b2w->GetJointList(); p_b2j; p_b2j = p_b2j->GetNext())
-        joints.push_back(p_b2j);
+    // dicts of destroyed objects (and of fixtures encoded again) stay unreachable until compacted, since
+    // the document could hold dicts of its own, which only the caller knows to keep
+    if (edited)
+        builder.finish();
+}
 
-    for (int j = joints.size() - 1; j >= 0; --j) // reverse order
+auto db2Decoder::Encode_New_Body(db2Builder &builder, b2Body &b2b, const bool withDerived) -> uint32_t
+{
+    auto count = db2Decoder::Count(b2b.GetFixtureList());
+
+    // the body dict is followed by the dicts of its fixtures
+    auto body_dict_i = builder.append<CKDict>(1 + count);
+    auto body_i = builder.append<CKBody>(1);
+    db2Decoder::Encode_Fixture_Dicts(builder, b2b, body_dict_i + 1, count, withDerived);
+
+    auto &dicts = builder.pool<CKDict>();
+    /*.userData*/ dicts[body_dict_i].runtime = &b2b;
+    /*userData*/ b2b.GetUserData().pointer = (uintptr_t)body_dict_i;
+
+    auto &body_dict = dicts[body_dict_i];
+    body_dict.reserve(2, false);
+    db2Builder::Link<CKBody>(body_dict, db2Key::Base, body_i);
+    db2Decoder::Encode_Body(b2b, builder.pool<CKBody>()[body_i]);
+
+    /*fixture*/
+    if (count == 0)
+        return body_dict_i;
+
+    auto list_i = builder.append<CKList>(1);
+    db2Builder::Link<CKList>(body_dict, db2Key::FIXTURE, list_i);
+    db2Builder::Link<CKDict>(builder.pool<CKList>()[list_i], body_dict_i + 1, count);
+    return body_dict_i;
+}
+
+auto db2Decoder::Encode_Fixture_Dicts(db2Builder &builder, b2Body &b2b, const uint32_t fixture_dict_i, const uint32_t count, const bool withDerived) -> void
+{
+    auto fixture_i = builder.append<CKFixture>(count);
+    auto shape_i = builder.append<CKShape>(count);
+    auto derived_i = builder.append<CKDerived>(withDerived ? count : 0);
+
+    auto &dicts = builder.pool<CKDict>();
+    auto f = count;
+    for (auto p_b2f = b2b.GetFixtureList(); p_b2f; p_b2f = p_b2f->GetNext())
     {
-        auto p_b2j = joints[j];
+        --f;
+        /*.userData*/ dicts[fixture_dict_i + f].runtime = p_b2f;
+        /*userData*/ p_b2f->GetUserData().pointer = (uintptr_t)(fixture_dict_i + f);
 
-        auto joint_dict_i = dicts.size();
-        {
-            auto &world_joint_list = dicts[world_dict_i].get<CKList>(db2Key::JOINT);
-            auto &joint_dict = world_joint_list.emplace_back<CKDict>();
-            auto &db2j = joint_dict.emplace<CKJoint>(db2Key::Base);
-            db2Decoder::Encode_Joint(*p_b2j, db2j);
+        db2Decoder::Encode_Fixture_Dict(builder, fixture_dict_i + f, *p_b2f, fixture_i + f, shape_i + f, withDerived ? derived_i + f : UINT32_MAX);
+    }
+}
+
+auto db2Decoder::Overwrite_Fixtures(CKDict &dicts, b2Body &b2b, db2List &fixture_list, const uint32_t count) -> bool
+{
+    // the same fixtures are attached if each is mapped and none was added
+    if (count != (fixture_list != nullval ? fixture_list.size() : 0))
+        return false;
+    for (auto p_b2f = b2b.GetFixtureList(); p_b2f; p_b2f = p_b2f->GetNext())
+        if (!db2Decoder::Is_Mapped(dicts, p_b2f))
+            return false;
+
+    db2FixtureView fixture{};
+    for (auto p_b2f = b2b.GetFixtureList(); p_b2f; p_b2f = p_b2f->GetNext())
+    {
+        if (!fixture.bind(dicts[p_b2f->GetUserData().pointer]))
+            continue;
 
-            /*.userData*/ joint_dict.runtime = p_b2j;
-            /*userData*/ p_b2j->GetUserData().pointer = (uintptr_t)joint_dict_i;
+        auto &db2f = fixture.base();
+        db2Decoder::Encode_Fixture(*p_b2f, db2f);
+
+        auto &db2s = fixture.shape();
+        db2s.shrink(0); // detached, then encoded again
+        db2Decoder::Encode_Shpae(*p_b2f->GetShape(), db2s);
+
+        if (auto &db2d = fixture.derived(); db2d != nullval)
+        {
+            db2d.shrink(0);
+            db2Decoder::Encode_Derived(*p_b2f, db2Decoder::Hash_Derived(db2f, db2s), db2d);
         }
+    }
+    return true;
+}
 
-        if (p_b2j->GetType() != b2JointType::e_gearJoint)
+template <typename T>
+auto db2Decoder::Is_Mapped(CKDict &dicts, T *p_b2) -> bool
+{
+    // userData of objects created since encoding is 0, the default of Box2D, which maps to no dict, and
+    // they could reuse the address of a destroyed object, whose dict keeps it until unlisted
+    auto d = p_b2->GetUserData().pointer;
+    if (d == 0 || d >= dicts.size() || dicts[d].runtime != p_b2)
+        return false;
+
+    // so the dict should also be one of an object of that type
+    using CK_T = std::conditional_t<std::is_same_v<T, b2Body>, CKBody,
+                                    std::conditional_t<std::is_same_v<T, b2Fixture>, CKFixture, CKJoint>>;
+    return dicts[d].template find<CK_T>(db2Key::Base) != nullval;
+}
+
+template <typename T>
+auto db2Decoder::Unlist(CKDict &dicts, db2List &list, T *p_b2_first) -> void
+{
+    // mapped objects mark their dicts by the lowest bit of runtime, which is free since Box2D objects are aligned
+    for (auto p_b2 = p_b2_first; p_b2; p_b2 = p_b2->GetNext())
+        if (db2Decoder::Is_Mapped(dicts, p_b2))
+            dicts[p_b2->GetUserData().pointer].runtime = (void *)((uintptr_t)p_b2 | 1);
+
+    // unmarked dicts are of destroyed objects, whose runtimes are dangling
+    list.detach();
+    uint32_t kept = 0;
+    for (uint32_t i = 0; i < list.size(); ++i)
+    {
+        auto &dict = dicts.at(list[i]);
+        if (dict == nullval)
+            continue;
+
+        if ((uintptr_t)dict.runtime & 1)
         {
-            auto &joint_body_list = dicts[joint_dict_i].get<CKList>(db2Key::BODY);
-            /*bodyA*/ joint_body_list.emplace_back_ref<CKBody>(p_b2j->GetBodyA()->GetUserData().pointer);
-            /*bodyB*/ joint_body_list.emplace_back_ref<CKBody>(p_b2j->GetBodyB()->GetUserData().pointer);
+            list[kept++] = list[i];
+            continue;
         }
-        else
+
+        dict.runtime = nullptr;
+        if constexpr (std::is_same_v<T, b2Body>)
         {
-            auto &joint_joint_list = dicts[joint_dict_i].get<CKList>(db2Key::JOINT);
-            /*joint1*/ joint_joint_list.emplace_back_ref<CKJoint>(((b2GearJoint *)p_b2j)->GetJoint1()->GetUserData().pointer);
-            /*joint2*/ joint_joint_list.emplace_back_ref<CKJoint>(((b2GearJoint *)p_b2j)->GetJoint2()->GetUserData().pointer);
+            db2BodyView body{};
+            body.bind(dict);
+            auto &fixture_list = body.fixtures();
+            for (uint32_t f = 0; fixture_list != nullval && f < fixture_list.size(); ++f)
+                if (auto &fixture_dict = dicts.at(fixture_list[f]); fixture_dict != nullval)
+                    fixture_dict.runtime = nullptr;
         }
     }
+    list.shrink(kept);
+
+    for (auto p_b2 = p_b2_first; p_b2; p_b2 = p_b2->GetNext())
+        if (auto d = p_b2->GetUserData().pointer; d < dicts.size() && dicts[d].runtime == (void *)((uintptr_t)p_b2 | 1))
+            dicts[d].runtime = p_b2;
+}
+
+auto db2Decoder::Count(b2Fixture *p_b2f) -> uint32_t
+{
+    uint32_t count = 0;
+    for (; p_b2f; p_b2f = p_b2f->GetNext())
+        ++count;
+    return count;
 }
 
 auto db2Decoder::Encode_World(b2World &b2w, db2World &db2w) -> void
@@ -579,52 +1046,27 @@ auto db2Decoder::Encode_Fixture(b2Fixture &b2f, db2Fixture &db2f) -> void
 
 auto db2Decoder::Encode_Shpae(b2Shape &b2s, db2Shape &db2s) -> void
 {
+    static_assert(sizeof(b2Vec2) == 8);
+
     /*shape_type*/ db2s.type3() = b2s.m_type;
-    /*shape_radius*/ db2s.emplace_back(b2s.m_radius);
 
     switch (b2s.m_type)
     {
     case b2Shape::e_circle:
-    {
-        auto &b2s_c = reinterpret_cast<b2CircleShape &>(b2s);
-
-        db2s.reserve(1 + 1 * 2);
-
-        db2s.emplace_back(b2s_c.m_p.x);
-        db2s.emplace_back(b2s_c.m_p.y);
-    }
-    break;
+        db2Decoder::Encode_Shpae<db2CircleShapeCodec>(b2s, db2s);
+        break;
 
     case b2Shape::e_edge:
-    {
-        auto &b2s_e = reinterpret_cast<b2EdgeShape &>(b2s);
-
-        db2s.reserve(1 + 4 * 2 + 1);
-
-        db2s.emplace_back(b2s_e.m_vertex0.x);
-        db2s.emplace_back(b2s_e.m_vertex0.y);
-        db2s.emplace_back(b2s_e.m_vertex1.x);
-        db2s.emplace_back(b2s_e.m_vertex1.y);
-        db2s.emplace_back(b2s_e.m_vertex2.x);
-        db2s.emplace_back(b2s_e.m_vertex2.y);
-        db2s.emplace_back(b2s_e.m_vertex3.x);
-        db2s.emplace_back(b2s_e.m_vertex3.y);
-
-        db2s.emplace_back((float32_t)b2s_e.m_oneSided);
-    }
-    break;
+        db2Decoder::Encode_Shpae<db2EdgeShapeCodec>(b2s, db2s);
+        break;
 
     case b2Shape::e_polygon:
     {
         auto &b2s_p = reinterpret_cast<b2PolygonShape &>(b2s);
 
-        db2s.reserve(1 + b2s_p.m_count * 2);
-
-        for (int i = 0; i < b2s_p.m_count; ++i)
-        {
-            db2s.emplace_back(b2s_p.m_vertices[i].x);
-            db2s.emplace_back(b2s_p.m_vertices[i].y);
-        }
+        db2s.reserve(1 + b2s_p.m_count * 2, false);
+        db2s.emplace_back(b2s_p.m_radius);
+        db2s.append_span({&b2s_p.m_vertices[0].x, size_t(b2s_p.m_count * 2)}); // b2Vec2s are packed floats
     }
     break;
 
@@ -632,20 +1074,52 @@ auto db2Decoder::Encode_Shpae(b2Shape &b2s, db2Shape &db2s) -> void
     {
         auto &b2s_chain = reinterpret_cast<b2ChainShape &>(b2s);
 
-        db2s.reserve(1 + b2s_chain.m_count * 2 + 2 * 2);
-
-        for (int i = 0; i < b2s_chain.m_count; ++i)
-        {
-            db2s.emplace_back(b2s_chain.m_vertices[i].x);
-            db2s.emplace_back(b2s_chain.m_vertices[i].y);
-        }
-
-        db2s.emplace_back(b2s_chain.m_prevVertex.x);
-        db2s.emplace_back(b2s_chain.m_prevVertex.y);
-        db2s.emplace_back(b2s_chain.m_nextVertex.x);
-        db2s.emplace_back(b2s_chain.m_nextVertex.y);
+        db2s.reserve(1 + b2s_chain.m_count * 2 + 2 * 2, false);
+        db2s.emplace_back(b2s_chain.m_radius);
+        db2s.append_span({&b2s_chain.m_vertices[0].x, size_t(b2s_chain.m_count * 2)});
+        db2s.append_range({
+            b2s_chain.m_prevVertex.x, b2s_chain.m_prevVertex.y,
+            b2s_chain.m_nextVertex.x, b2s_chain.m_nextVertex.y //
+        });
     }
     break;
+
+    default:
+        db2s.emplace_back(b2s.m_radius);
+        break;
+    }
+}
+
+template <typename Codec>
+auto db2Decoder::Encode_Shpae(b2Shape &b2s, db2Shape &db2s) -> void
+{
+    auto size = db2s.size();
+    db2s.expand(size + 1 + Codec::count, false);
+    db2s[size] = b2s.m_radius;
+    Codec::Encode(reinterpret_cast<typename Codec::object_type &>(b2s), &db2s[size + 1]);
+}
+
+auto db2Decoder::Encode_Derived(b2Fixture &b2f, const uint32_t hash, db2Derived &db2d) -> void
+{
+    static_assert(sizeof(b2Vec2) == 8);
+
+    auto &b2s = *b2f.GetShape();
+    /*shape_type*/ db2d.type3() = b2s.m_type;
+
+    b2MassData mass;
+    b2f.GetMassData(&mass); // as b2Body::ResetMassData computes it
+
+    db2d.reserve(5 + (b2s.m_type == b2Shape::e_polygon ? 2 + b2_maxPolygonVertices * 2 : 0), false);
+    db2d.emplace_back();
+    std::memcpy(&db2d[0], &hash, sizeof(hash)); // bits, not a float
+    db2d.append_range({mass.mass, mass.center.x, mass.center.y, mass.I});
+
+    if (b2s.m_type == b2Shape::e_polygon)
+    {
+        auto &b2s_p = reinterpret_cast<b2PolygonShape &>(b2s);
+
+        db2d.append_range({b2s_p.m_centroid.x, b2s_p.m_centroid.y});
+        db2d.append_span({&b2s_p.m_normals[0].x, size_t(b2s_p.m_count * 2)});
     }
 }
 
@@ -657,161 +1131,55 @@ auto db2Decoder::Encode_Joint(b2Joint &b2j, db2Joint &db2j) -> void
     switch (b2j.GetType())
     {
     case b2JointType::e_revoluteJoint:
-    {
-        auto &b2j_r = reinterpret_cast<b2RevoluteJoint &>(b2j);
-        db2j.emplace_back(b2j_r.GetLocalAnchorA().x);
-        db2j.emplace_back(b2j_r.GetLocalAnchorA().y);
-        db2j.emplace_back(b2j_r.GetLocalAnchorB().x);
-        db2j.emplace_back(b2j_r.GetLocalAnchorB().y);
-        db2j.emplace_back(b2j_r.GetReferenceAngle());
-        db2j.emplace_back((float32_t)b2j_r.IsLimitEnabled());
-        db2j.emplace_back(b2j_r.GetLowerLimit());
-        db2j.emplace_back(b2j_r.GetUpperLimit());
-        db2j.emplace_back((float32_t)b2j_r.IsMotorEnabled());
-        db2j.emplace_back(b2j_r.GetMotorSpeed());
-        db2j.emplace_back(b2j_r.GetMaxMotorTorque());
-    }
-    break;
+        db2Decoder::Encode_Joint<db2RevoluteJointCodec>(b2j, db2j);
+        break;
 
     case b2JointType::e_prismaticJoint:
-    {
-        auto &b2j_p = reinterpret_cast<b2PrismaticJoint &>(b2j);
-        db2j.emplace_back(b2j_p.GetLocalAnchorA().x);
-        db2j.emplace_back(b2j_p.GetLocalAnchorA().y);
-        db2j.emplace_back(b2j_p.GetLocalAnchorB().x);
-        db2j.emplace_back(b2j_p.GetLocalAnchorB().y);
-        db2j.emplace_back(b2j_p.GetLocalAxisA().x);
-        db2j.emplace_back(b2j_p.GetLocalAxisA().y);
-        db2j.emplace_back(b2j_p.GetReferenceAngle());
-        db2j.emplace_back((float32_t)b2j_p.IsLimitEnabled());
-        db2j.emplace_back(b2j_p.GetLowerLimit());
-        db2j.emplace_back(b2j_p.GetUpperLimit());
-        db2j.emplace_back((float32_t)b2j_p.IsMotorEnabled());
-        db2j.emplace_back(b2j_p.GetMaxMotorForce());
-        db2j.emplace_back(b2j_p.GetMotorSpeed());
-    }
-    break;
+        db2Decoder::Encode_Joint<db2PrismaticJointCodec>(b2j, db2j);
+        break;
 
     case b2JointType::e_distanceJoint:
-    {
-        auto &b2j_d = reinterpret_cast<b2DistanceJoint &>(b2j);
-        db2j.emplace_back(b2j_d.GetLocalAnchorA().x);
-        db2j.emplace_back(b2j_d.GetLocalAnchorA().y);
-        db2j.emplace_back(b2j_d.GetLocalAnchorB().x);
-        db2j.emplace_back(b2j_d.GetLocalAnchorB().y);
-        db2j.emplace_back(b2j_d.GetLength());
-        db2j.emplace_back(b2j_d.GetMinLength());
-        db2j.emplace_back(b2j_d.GetMaxLength());
-        db2j.emplace_back(b2j_d.GetStiffness());
-        db2j.emplace_back(b2j_d.GetDamping());
-    }
-    break;
+        db2Decoder::Encode_Joint<db2DistanceJointCodec>(b2j, db2j);
+        break;
 
     case b2JointType::e_pulleyJoint:
-    {
-        auto &b2j_p = reinterpret_cast<b2PulleyJoint &>(b2j);
-        db2j.emplace_back(b2j_p.GetGroundAnchorA().x);
-        db2j.emplace_back(b2j_p.GetGroundAnchorA().y);
-        db2j.emplace_back(b2j_p.GetGroundAnchorB().x);
-        db2j.emplace_back(b2j_p.GetGroundAnchorB().y);
-
-        auto localAnchorA = b2j_p.GetBodyA()->GetLocalPoint(b2j_p.GetAnchorA());
-        db2j.emplace_back(localAnchorA.x);
-        db2j.emplace_back(localAnchorA.y);
-        auto localAnchorB = b2j_p.GetBodyB()->GetLocalPoint(b2j_p.GetAnchorB());
-        db2j.emplace_back(localAnchorB.x);
-        db2j.emplace_back(localAnchorB.y);
-
-        db2j.emplace_back(b2j_p.GetLengthA());
-        db2j.emplace_back(b2j_p.GetLengthB());
-        db2j.emplace_back(b2j_p.GetRatio());
-    }
-    break;
+        db2Decoder::Encode_Joint<db2PulleyJointCodec>(b2j, db2j);
+        break;
 
     case b2JointType::e_mouseJoint:
-    {
-        auto &b2j_m = reinterpret_cast<b2MouseJoint &>(b2j);
-        db2j.emplace_back(b2j_m.GetTarget().x);
-        db2j.emplace_back(b2j_m.GetTarget().y);
-        db2j.emplace_back(b2j_m.GetMaxForce());
-        db2j.emplace_back(b2j_m.GetStiffness());
-        db2j.emplace_back(b2j_m.GetDamping());
-    }
-    break;
+        db2Decoder::Encode_Joint<db2MouseJointCodec>(b2j, db2j);
+        break;
 
     case b2JointType::e_gearJoint:
-    {
-        auto &b2j_g = reinterpret_cast<b2GearJoint &>(b2j);
-        // db2j.emplace_back((float32_t)b2j_g.GetJoint1()->GetUserData().pointer);
-        // db2j.emplace_back((float32_t)b2j_g.GetJoint2()->GetUserData().pointer);
-        db2j.emplace_back(b2j_g.GetRatio());
-    }
-    break;
+        db2Decoder::Encode_Joint<db2GearJointCodec>(b2j, db2j);
+        break;
 
     case b2JointType::e_wheelJoint:
-    {
-        auto &b2j_w = reinterpret_cast<b2WheelJoint &>(b2j);
-        db2j.emplace_back(b2j_w.GetLocalAnchorA().x);
-        db2j.emplace_back(b2j_w.GetLocalAnchorA().y);
-        db2j.emplace_back(b2j_w.GetLocalAnchorB().x);
-        db2j.emplace_back(b2j_w.GetLocalAnchorB().y);
-        db2j.emplace_back(b2j_w.GetLocalAxisA().x);
-        db2j.emplace_back(b2j_w.GetLocalAxisA().y);
-        db2j.emplace_back((float32_t)b2j_w.IsLimitEnabled());
-        db2j.emplace_back(b2j_w.GetLowerLimit());
-        db2j.emplace_back(b2j_w.GetUpperLimit());
-        db2j.emplace_back((float32_t)b2j_w.IsMotorEnabled());
-        db2j.emplace_back(b2j_w.GetMaxMotorTorque());
-        db2j.emplace_back(b2j_w.GetMotorSpeed());
-        db2j.emplace_back(b2j_w.GetStiffness());
-        db2j.emplace_back(b2j_w.GetDamping());
-    }
-    break;
+        db2Decoder::Encode_Joint<db2WheelJointCodec>(b2j, db2j);
+        break;
 
     case b2JointType::e_weldJoint:
-    {
-        auto &b2j_wd = reinterpret_cast<b2WeldJoint &>(b2j);
-        db2j.emplace_back(b2j_wd.GetLocalAnchorA().x);
-        db2j.emplace_back(b2j_wd.GetLocalAnchorA().y);
-        db2j.emplace_back(b2j_wd.GetLocalAnchorB().x);
-        db2j.emplace_back(b2j_wd.GetLocalAnchorB().y);
-        db2j.emplace_back(b2j_wd.GetReferenceAngle());
-        db2j.emplace_back(b2j_wd.GetStiffness());
-        db2j.emplace_back(b2j_wd.GetDamping());
-    }
-    break;
+        db2Decoder::Encode_Joint<db2WeldJointCodec>(b2j, db2j);
+        break;
 
     case b2JointType::e_frictionJoint:
-    {
-        auto &b2j_f = reinterpret_cast<b2FrictionJoint &>(b2j);
-        db2j.emplace_back(b2j_f.GetLocalAnchorA().x);
-        db2j.emplace_back(b2j_f.GetLocalAnchorA().y);
-        db2j.emplace_back(b2j_f.GetLocalAnchorB().x);
-        db2j.emplace_back(b2j_f.GetLocalAnchorB().y);
-        db2j.emplace_back(b2j_f.GetMaxForce());
-        db2j.emplace_back(b2j_f.GetMaxTorque());
-    }
-    break;
-
-    case b2JointType::e_ropeJoint:
-    {
-        // auto b2j_r = (b2RopeJoint *)b2j;
-    }
-    break;
+        db2Decoder::Encode_Joint<db2FrictionJointCodec>(b2j, db2j);
+        break;
 
     case b2JointType::e_motorJoint:
-    {
-        auto &b2j_m = reinterpret_cast<b2MotorJoint &>(b2j);
-        db2j.emplace_back(b2j_m.GetLinearOffset().x);
-        db2j.emplace_back(b2j_m.GetLinearOffset().y);
-        db2j.emplace_back(b2j_m.GetAngularOffset());
-        db2j.emplace_back(b2j_m.GetMaxForce());
-        db2j.emplace_back(b2j_m.GetMaxTorque());
-        db2j.emplace_back(b2j_m.GetCorrectionFactor());
-    }
-    break;
+        db2Decoder::Encode_Joint<db2MotorJointCodec>(b2j, db2j);
+        break;
 
+    case b2JointType::e_ropeJoint: // b2RopeJoint
     default:
         break;
     }
 }
+
+template <typename Codec>
+auto db2Decoder::Encode_Joint(b2Joint &b2j, db2Joint &db2j) -> void
+{
+    auto size = db2j.size();
+    db2j.expand(size + Codec::count, false);
+    Codec::Encode(reinterpret_cast<typename Codec::object_type &>(b2j), &db2j[size]);
+}
@@ -1,23 +1,77 @@
 #pragma once
 
+#include <variant>
+
 #include "box2d/box2d.h"
 
 #include "dotBox2d.h"
+#include "data/db2_views.h"
+#include "containers/db2_builder.h"
+#include "decoders/db2_codec.h"
 
 class db2Decoder
 {
+public:
+    // shapes and joint defs are decoded in place, Box2D copies them on creation
+    using Shape = std::variant<std::monostate, b2CircleShape, b2EdgeShape, b2PolygonShape, b2ChainShape>;
+    using JointDef = std::variant<std::monostate, b2RevoluteJointDef, b2PrismaticJointDef, b2DistanceJointDef, b2PulleyJointDef,
+                                  b2MouseJointDef, b2GearJointDef, b2WheelJointDef, b2WeldJointDef, b2FrictionJointDef, b2MotorJointDef>;
+
+    struct BodyDefs // defs of a range of the world bodies, built apart from the world
+    {
+        db2DynArray<b2BodyDef> bodies{};
+        db2DynArray<uint32_t> fixture_counts{}; // fixtures of each body, in order
+        db2DynArray<b2FixtureDef> fixtures{};   // shapes point into shapes
+        db2DynArray<Shape> shapes{};            // shape of each fixture
+        db2DynArray<b2MassData> masses{};       // mass of each body, summed over its fixtures
+    };
+
 public:
     static auto Decode(dotBox2d &db2) -> void;
+    static auto Decode_Bodies(CKDict &dicts, db2List &world_body_list, const uint32_t begin, const uint32_t end, BodyDefs &defs) -> void; // reads the CSON graph only, through const lookups, so it runs across threads
+    static auto Prepare_Bodies(db2Chunks &chunks) -> void; // indexes what Decode_Bodies finds, which it expects (and asserts)
+    static auto Create_World(dotBox2d &db2, db2World &db2w) -> void;
+    static auto Create_Bodies(dotBox2d &db2, BodyDefs &defs, db2DynArray<b2Body *> &disabled) -> void; // bodies to be enabled are created disabled, and appended
+    static auto Enable_Bodies(db2DynArray<b2Body *> &bodies) -> void;                                 // inserts their proxies in spatial order
+    static auto Sort_Bodies(db2DynArray<b2Body *> &bodies) -> void;                                   // along a Z-order curve over their positions
+    static auto Create_Joint(dotBox2d &db2, CKDict &dicts, db2List &joint_list, const uint32_t j, db2JointView &joint) -> b2Joint *; // nullptr until the objects it links exist
     static auto Decode_World(db2World &db2w, b2Vec2 &gravity) -> void;
     static auto Decode_Body(db2Body &db2b, b2BodyDef &b2bdef) -> void;
     static auto Decode_Fixture(db2Fixture &db2f, b2FixtureDef &b2fdef) -> void;
-    static auto Decode_Shpae(db2Shape &db2s, b2Shape *&p_b2s) -> void;
-    static auto Decode_Joint(db2Joint &db2j, b2JointDef *&p_b2jdef) -> void;
+    static auto Decode_Shpae(db2Shape &db2s, Shape &b2s, db2Derived *p_db2d = nullptr) -> b2Shape *; // p_db2d if up to date, nullptr for unknown types
+    static auto Decode_Joint(db2Joint &db2j, JointDef &b2jdef) -> b2JointDef *;                          // nullptr for unknown types
+
+    static auto Morton(uint32_t x) -> uint32_t; // spreads the lower 16 bits of x to the even bits
 
-    static auto Encode(dotBox2d &db2) -> void;
+    static auto Hash_Derived(db2Fixture &db2f, db2Shape &db2s) -> uint32_t;
+
+    static auto Encode(dotBox2d &db2, const bool withDerived = false) -> void;
+    static auto Count(b2Fixture *p_b2f) -> uint32_t; // fixtures of a list
+    static auto Encode_Fixture_Dict(db2Builder &builder, const uint32_t fixture_dict_i, b2Fixture &b2f, const uint32_t fixture_i, const uint32_t shape_i, const uint32_t derived_i) -> void; // UINT32_MAX for no derived
+    static auto Encode_Joint_Dict(db2Builder &builder, const uint32_t joint_dict_i, b2Joint &b2j, const uint32_t joint_i, const uint32_t list_i) -> void; // bodies or joints linked should be mapped
+
+    static auto Reencode(dotBox2d &db2, const uint32_t world_dict_i, const bool withDerived = false) -> void; // overwrites mapped objects, appends new ones, unlists destroyed ones, whose dicts are left to dotBox2d::compact
+    static auto Encode_New_Body(db2Builder &builder, b2Body &b2b, const bool withDerived) -> uint32_t; // returns the body dict
+    static auto Encode_Fixture_Dicts(db2Builder &builder, b2Body &b2b, const uint32_t fixture_dict_i, const uint32_t count, const bool withDerived) -> void; // into count dicts appended from fixture_dict_i
+    static auto Overwrite_Fixtures(CKDict &dicts, b2Body &b2b, db2List &fixture_list, const uint32_t count) -> bool;   // false if fixtures were added or destroyed, and nothing is written
+    template <typename T> // b2Body or b2Joint, whose userData and dict runtime point to each other
+    static auto Is_Mapped(CKDict &dicts, T *p_b2) -> bool;
+    template <typename T>
+    static auto Unlist(CKDict &dicts, db2List &list, T *p_b2_first) -> void; // drops dicts of destroyed objects from list
     static auto Encode_World(b2World &b2w, db2World &db2w) -> void;
     static auto Encode_Body(b2Body &b2b, db2Body &db2b) -> void;
     static auto Encode_Fixture(b2Fixture &b2f, db2Fixture &db2f) -> void;
     static auto Encode_Shpae(b2Shape &b2s, db2Shape &db2s) -> void;
+    static auto Encode_Derived(b2Fixture &b2f, const uint32_t hash, db2Derived &db2d) -> void;
+    static auto Encode_Joint(b2Joint &b2j, db2Joint &db2j) -> void;
+
+private: // instantiated in db2_decoder.cpp only
+    template <typename Codec> // by the fields of the codec, see db2_codec.h
+    static auto Decode_Shpae(db2Shape &db2s, Shape &b2s) -> b2Shape *;
+    template <typename Codec>
+    static auto Decode_Joint(db2Joint &db2j, JointDef &b2jdef) -> b2JointDef *;
+    template <typename Codec>
+    static auto Encode_Shpae(b2Shape &b2s, db2Shape &db2s) -> void;
+    template <typename Codec>
     static auto Encode_Joint(b2Joint &b2j, db2Joint &db2j) -> void;
 };
\ No newline at end of file
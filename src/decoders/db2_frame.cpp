@@ -0,0 +1,145 @@
+#include "db2_frame.h"
+
+#include <algorithm> // std::clamp
+#include <cmath>     // std::round
+#include <limits>
+
+auto db2Frame::Encode(dotBox2d &db2, db2Chunks &frame, const bool quantized) -> void
+{
+    if (!db2.p_b2w)
+        return;
+
+    auto &base = frame.get<CKFrameBase>();
+    base.resize(1);
+    base.detach();
+    base[0] = db2Frame::Identify(*db2.p_b2w);
+
+    // a frame holds states of one kind, the other is emptied if a frame is reused
+    auto &states = frame.at<CKState>();
+    auto &states_q = frame.at<CKStateQ>();
+    if (quantized)
+    {
+        if (states != nullval)
+            states.shrink(0);
+        db2Frame::Encode_States(*db2.p_b2w, frame.get<CKStateQ>());
+    }
+    else
+    {
+        if (states_q != nullval)
+            states_q.shrink(0);
+        db2Frame::Encode_States(*db2.p_b2w, frame.get<CKState>());
+    }
+}
+
+auto db2Frame::Decode(dotBox2d &db2, db2Chunks &frame) -> bool
+{
+    if (!db2.p_b2w)
+        return false;
+
+    auto &base = frame.at<CKFrameBase>();
+    auto identity = db2Frame::Identify(*db2.p_b2w);
+    if (base == nullval || base.size() != 1 || base[0].body_count != identity.body_count || base[0].body_hash != identity.body_hash)
+        return false; // encoded from another world
+
+    auto &states = frame.at<CKState>();
+    auto &states_q = frame.at<CKStateQ>();
+    if (states_q != nullval && (states == nullval || states.size() == 0))
+        return db2Frame::Decode_States(*db2.p_b2w, states_q);
+    return states != nullval && db2Frame::Decode_States(*db2.p_b2w, states);
+}
+
+template <typename CK_T>
+auto db2Frame::Encode_States(b2World &b2w, CK_T &states) -> void
+{
+    // Box2D's list is in reverse world list order, states are placed from the end
+    uint32_t count = 0;
+    for (auto p_b2b = b2w.GetBodyList(); p_b2b; p_b2b = p_b2b->GetNext())
+        count += p_b2b->GetType() != b2_staticBody;
+    states.expand(count, false);
+    states.shrink(count);
+    states.detach();
+
+    auto i = count;
+    for (auto p_b2b = b2w.GetBodyList(); p_b2b; p_b2b = p_b2b->GetNext())
+        if (p_b2b->GetType() != b2_staticBody)
+            db2Frame::Encode_State(*p_b2b, states[--i]);
+}
+
+template <typename CK_T>
+auto db2Frame::Decode_States(b2World &b2w, CK_T &states) -> bool
+{
+    uint32_t count = 0;
+    for (auto p_b2b = b2w.GetBodyList(); p_b2b; p_b2b = p_b2b->GetNext())
+        count += p_b2b->GetType() != b2_staticBody;
+    if (states.size() != count)
+        return false;
+
+    auto i = count;
+    for (auto p_b2b = b2w.GetBodyList(); p_b2b; p_b2b = p_b2b->GetNext())
+        if (p_b2b->GetType() != b2_staticBody)
+            db2Frame::Decode_State(states[--i], *p_b2b);
+    return true;
+}
+
+auto db2Frame::Identify(b2World &b2w) -> db2FrameBase
+{
+    db2FrameBase base{uint32_t(b2w.GetBodyCount()), 0x811C9DC5u}; // FNV offset basis
+    for (auto p_b2b = b2w.GetBodyList(); p_b2b; p_b2b = p_b2b->GetNext())
+    {
+        auto key = int32_t(p_b2b->GetUserData().pointer << 1 | (p_b2b->GetType() == b2_staticBody));
+        base.body_hash = db2HashIndex::Combine(base.body_hash, db2HashIndex::Hash(key));
+    }
+    return base;
+}
+
+auto db2Frame::Encode_State(b2Body &b2b, db2State &db2s) -> void
+{
+    db2s.position_x = b2b.GetPosition().x;
+    db2s.position_y = b2b.GetPosition().y;
+    db2s.angle = b2b.GetAngle();
+    db2s.linearVelocity_x = b2b.GetLinearVelocity().x;
+    db2s.linearVelocity_y = b2b.GetLinearVelocity().y;
+    db2s.angularVelocity = b2b.GetAngularVelocity();
+    db2s.awake = b2b.IsAwake();
+}
+
+auto db2Frame::Encode_State(b2Body &b2b, db2StateQ &db2s) -> void
+{
+    db2s.position_x = db2Frame::Quantize<int32_t>(b2b.GetPosition().x, DB2_FRAME_POSITION_STEP);
+    db2s.position_y = db2Frame::Quantize<int32_t>(b2b.GetPosition().y, DB2_FRAME_POSITION_STEP);
+    // Box2D does not wrap angles, and joint angles are taken from them as they are, so whole turns are kept
+    auto turns = db2Frame::Quantize<int16_t>(b2b.GetAngle(), 2.0f * b2_pi);
+    db2s.angle = db2Frame::Quantize<int16_t>(float32_t(b2b.GetAngle() - float64_t(turns) * (2.0 * b2_pi)), b2_pi / 32768.0f);
+    db2s.turns = turns;
+    db2s.linearVelocity_x = db2Frame::Quantize<int16_t>(b2b.GetLinearVelocity().x, DB2_FRAME_VELOCITY_STEP);
+    db2s.linearVelocity_y = db2Frame::Quantize<int16_t>(b2b.GetLinearVelocity().y, DB2_FRAME_VELOCITY_STEP);
+    db2s.angularVelocity = db2Frame::Quantize<int16_t>(b2b.GetAngularVelocity(), DB2_FRAME_VELOCITY_STEP);
+    db2s.awake = b2b.IsAwake();
+}
+
+auto db2Frame::Decode_State(db2State &db2s, b2Body &b2b) -> void
+{
+    b2b.SetTransform({db2s.position_x, db2s.position_y}, db2s.angle);
+
+    // velocities wake a body up, and sleeping zeros them
+    b2b.SetLinearVelocity({db2s.linearVelocity_x, db2s.linearVelocity_y});
+    b2b.SetAngularVelocity(db2s.angularVelocity);
+    b2b.SetAwake(db2s.awake);
+}
+
+auto db2Frame::Decode_State(db2StateQ &db2s, b2Body &b2b) -> void
+{
+    auto angle = float64_t(db2s.turns) * (2.0 * b2_pi) + db2s.angle * (b2_pi / 32768.0);
+    b2b.SetTransform({db2s.position_x * DB2_FRAME_POSITION_STEP, db2s.position_y * DB2_FRAME_POSITION_STEP}, float32_t(angle));
+
+    b2b.SetLinearVelocity({db2s.linearVelocity_x * DB2_FRAME_VELOCITY_STEP, db2s.linearVelocity_y * DB2_FRAME_VELOCITY_STEP});
+    b2b.SetAngularVelocity(db2s.angularVelocity * DB2_FRAME_VELOCITY_STEP);
+    b2b.SetAwake(db2s.awake);
+}
+
+template <typename I>
+auto db2Frame::Quantize(const float32_t value, const float32_t step) -> I
+{
+    auto q = std::round(float64_t(value) / step);
+    return I(std::clamp(q, float64_t(std::numeric_limits<I>::min()), float64_t(std::numeric_limits<I>::max())));
+}
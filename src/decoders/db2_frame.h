@@ -0,0 +1,43 @@
+#pragma once
+
+#include "box2d/box2d.h"
+
+#include "dotBox2d.h"
+
+/*
+db2Frame encodes the dynamic state of bodies (position, angle, velocities and awake) into a frame,
+a document of a single dense chunk, for replays and netcode:
+
+    db2.encode_frame(frame, true); // quantized, see db2StateQ
+    ...
+    other.decode_frame(frame);     // other was decoded from the same document as db2
+
+States are keyed by the position of their bodies in the world body list, which is the order
+bodies are created in by decoding and appended in by encoding. Static bodies never move, and have
+no state. A frame also holds the identity of its world (see db2FrameBase): the body count and a
+hash of the body dicts, and is rejected by a world of another one. Everything else is left to the
+base document.
+*/
+
+class db2Frame
+{
+public:
+    static auto Encode(dotBox2d &db2, db2Chunks &frame, const bool quantized = false) -> void;
+    static auto Decode(dotBox2d &db2, db2Chunks &frame) -> bool; // false if frame does not match the world
+
+private:
+    template <typename CK_T>
+    static auto Encode_States(b2World &b2w, CK_T &states) -> void;
+    template <typename CK_T>
+    static auto Decode_States(b2World &b2w, CK_T &states) -> bool;
+
+    static auto Identify(b2World &b2w) -> db2FrameBase;
+
+    static auto Encode_State(b2Body &b2b, db2State &db2s) -> void;
+    static auto Encode_State(b2Body &b2b, db2StateQ &db2s) -> void;
+    static auto Decode_State(db2State &db2s, b2Body &b2b) -> void;
+    static auto Decode_State(db2StateQ &db2s, b2Body &b2b) -> void;
+
+    template <typename I>
+    static auto Quantize(const float32_t value, const float32_t step) -> I; // rounded and clamped
+};
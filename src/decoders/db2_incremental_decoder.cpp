@@ -0,0 +1,143 @@
+#include "db2_incremental_decoder.h"
+
+#include <algorithm> // std::min
+#include <chrono>
+
+auto db2IncrementalDecoder::step(const uint32_t objects, const float32_t milliseconds) -> bool
+{
+    using Clock = std::chrono::steady_clock;
+    auto deadline = Clock::now() + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<float32_t, std::milli>{milliseconds});
+
+    auto limit = objects > 0 ? objects : UINT32_MAX; // 0 for no count limit
+    uint32_t created = 0;
+    auto spent = [&]() -> bool
+    { return created >= limit || (milliseconds > 0.0f && Clock::now() >= deadline); };
+
+    auto &dicts = this->db2.chunks.at<CKDict>();
+    if (dicts == nullval || this->phase == Phase::Done)
+        return this->phase = Phase::Done, true;
+
+    /*world*/
+    if (this->phase == Phase::World)
+    {
+        this->world_dict_i = this->db2.world_dict_i();
+        if (this->db2.p_b2w || dicts.at(this->world_dict_i) == nullval)
+            return this->phase = Phase::Done, true;
+
+        this->world.bind(dicts.at(this->world_dict_i));
+        db2Decoder::Create_World(this->db2, this->world.base());
+        db2Decoder::Prepare_Bodies(this->db2.chunks);
+        this->phase = Phase::Bodies;
+    }
+    else
+    {
+        this->world.bind(dicts.at(this->world_dict_i)); // dicts could have been reallocated
+    }
+
+    /*body*/
+    while (this->phase == Phase::Bodies && !spent())
+    {
+        auto &world_body_list = this->world.bodies();
+        auto count = world_body_list != nullval ? world_body_list.size() : 0;
+        if (this->cursor >= count)
+        {
+            db2Decoder::Sort_Bodies(this->disabled);
+            this->phase = Phase::Proxies;
+            this->cursor = 0;
+            break;
+        }
+
+        auto end = this->cursor + std::min({count - this->cursor, uint32_t(DB2_DECODE_SLICE), limit - created});
+
+        db2Decoder::BodyDefs defs{};
+        db2Decoder::Decode_Bodies(dicts, world_body_list, this->cursor, end, defs);
+
+        db2Decoder::Create_Bodies(this->db2, defs, this->disabled);
+
+        created += end - this->cursor;
+        this->cursor = end;
+    }
+
+    /*proxy*/
+    while (this->phase == Phase::Proxies && !spent())
+    {
+        auto count = this->disabled.size();
+        if (this->cursor >= count)
+        {
+            this->disabled.shrink(0);
+            this->disabled.shrink_to_fit();
+
+            // joints find the objects they link by the runtime of their dicts, left over by earlier decodings
+            auto &world_joint_list = this->world.joints();
+            for (uint32_t j = 0; world_joint_list != nullval && j < world_joint_list.size(); ++j)
+                if (auto &joint_dict = dicts.at(world_joint_list[j]); joint_dict != nullval)
+                    joint_dict.runtime = nullptr;
+
+            this->phase = Phase::Joints;
+            this->cursor = 0;
+            break;
+        }
+
+        auto end = this->cursor + std::min({count - this->cursor, uint32_t(DB2_DECODE_SLICE), limit - created});
+        for (auto b = this->cursor; b < end; ++b)
+            this->disabled[b]->SetEnabled(true);
+
+        created += end - this->cursor;
+        this->cursor = end;
+    }
+
+    /*joint*/
+    if (this->phase == Phase::Joints)
+    {
+        auto &world_joint_list = this->world.joints();
+        if (world_joint_list == nullval)
+            return this->phase = Phase::Done, true;
+
+        while (!spent())
+        {
+            if (this->step_joint(dicts, world_joint_list))
+                ++created;
+            if (this->phase == Phase::Done)
+                break;
+        }
+    }
+
+    return this->phase == Phase::Done;
+}
+
+auto db2IncrementalDecoder::step_joint(CKDict &dicts, db2List &joint_list) -> bool // whether a joint is created
+{
+    // joints in order
+    if (this->cursor < joint_list.size())
+    {
+        auto j = this->cursor++;
+        if (db2Decoder::Create_Joint(this->db2, dicts, joint_list, j, this->joint))
+            return true;
+
+        this->waiting.push_back(j);
+        return false;
+    }
+
+    // then passes over waiting joints, until a pass creates none of them
+    if (this->waiting_cursor < this->waiting.size())
+    {
+        auto j = this->waiting[this->waiting_cursor++];
+        if (db2Decoder::Create_Joint(this->db2, dicts, joint_list, j, this->joint))
+            return this->waiting_progress = true;
+
+        this->waiting[this->waiting_kept++] = j;
+        return false;
+    }
+
+    this->waiting.shrink(this->waiting_kept);
+    if (this->waiting.size() == 0 || (!this->waiting_progress && this->waiting_cursor > 0))
+    {
+        this->phase = Phase::Done; // the rest could never be created
+        return false;
+    }
+
+    this->waiting_cursor = 0;
+    this->waiting_kept = 0;
+    this->waiting_progress = false;
+    return false;
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include "box2d/box2d.h"
+
+#include "dotBox2d.h"
+#include "decoders/db2_decoder.h"
+
+/*
+db2IncrementalDecoder decodes a world over several calls, so loading a large document does not
+stall a frame. Each step() creates objects until its budget, a count of bodies and joints, or a
+time in milliseconds, is used up, and resumes where the last one stopped:
+
+    while (!decoder.step(256, 2.0f)) // the world could be stepped in between
+        db2.step();
+
+The world is created by the first step, then bodies with their fixtures (in slices of
+DB2_DECODE_SLICE bodies), then their broadphase proxies, then joints. Bodies stay disabled until
+all of them exist, so their proxies are inserted in spatial order over the whole world, as
+db2Decoder::Decode does, and enabling a body counts against the budget as creating it does.
+A joint waits until the bodies or joints it links exist, and joints which never could are
+dropped. The chunks should not be edited until decoded.
+*/
+
+class db2IncrementalDecoder
+{
+public:
+    dotBox2d &db2;
+
+private:
+    enum class Phase
+    {
+        World,
+        Bodies,
+        Proxies,
+        Joints,
+        Done,
+    };
+
+    Phase phase{Phase::World};
+    uint32_t world_dict_i{UINT32_MAX};
+    uint32_t cursor{0}; // next body, or joint, of the world lists, or next body to enable
+
+    db2DynArray<b2Body *> disabled{}; // bodies created, to be enabled in spatial order
+
+    db2DynArray<uint32_t> waiting{}; // joints waiting for the objects they link
+    uint32_t waiting_cursor{0};      // next waiting joint of the current pass
+    uint32_t waiting_kept{0};        // joints still waiting in the current pass
+    bool waiting_progress{false};    // whether a joint was created in the current pass
+
+    db2WorldView world{};
+    db2JointView joint{};
+
+public:
+    db2IncrementalDecoder(dotBox2d &db2) : db2{db2} {}
+
+    auto step(const uint32_t objects, const float32_t milliseconds = 0.0f) -> bool; // true once decoded, 0 objects for no count limit, 0 ms for no time limit
+    auto done() const -> bool { return this->phase == Phase::Done; }
+
+private:
+    auto step_joint(CKDict &dicts, db2List &joint_list) -> bool; // false if no joint is left
+};
@@ -13,24 +13,24 @@ auto db2Transcoder::Transcode(dotBox2d &db2) -> void
     for (auto d = 0; d < dicts.size(); ++d)
     {
         auto &dict = dicts[d];
-        char *target_type = nullptr;
+
+        // elements are not necessarily ordered (see db2Dict::sort), so the base is looked up first
+        auto base = dict.slot(db2Key::Base);
+        if (base == UINT32_MAX)
+            continue;
+        auto &layout = dict.layout();
+        char *target_type = &layout[base].type0;
+
         for (auto e = 0; e < dict.size(); ++e)
         {
-            auto &elem = dict[e];
-            switch (elem.key)
-            {
-            case db2Key::Base:
+            switch (layout[e].key)
             {
-                target_type = &elem.type0;
-            }
-            break;
-
             case db2Key::BreakForce:
             {
                 if (db2Reflector::IsRefOf<CKBody>(target_type))
-                    db2Transcoder::Transcode_BreakForce_Body(db2, reinterpret_cast<b2Body *&>(dict.runtime), reinterpret_cast<float32_t &>(elem.value));
+                    db2Transcoder::Transcode_BreakForce_Body(db2, reinterpret_cast<b2Body *&>(dict.runtime), reinterpret_cast<float32_t &>(dict[e]));
                 else if (db2Reflector::IsRefOf<CKJoint>(target_type))
-                    db2Transcoder::Transcode_BreakForce_Joint(db2, reinterpret_cast<b2Joint *&>(dict.runtime), reinterpret_cast<float32_t &>(elem.value));
+                    db2Transcoder::Transcode_BreakForce_Joint(db2, reinterpret_cast<b2Joint *&>(dict.runtime), reinterpret_cast<float32_t &>(dict[e]));
             }
             break;
 
@@ -1,7 +1,10 @@
 #include "dotBox2d.h"
 
 #include "decoders/db2_decoder.h"
+#include "decoders/db2_frame.h"
+#include "decoders/db2_incremental_decoder.h"
 #include "decoders/db2_transcoder.h"
+#include "containers/db2_compactor.h"
 
 dotBox2d::dotBox2d(const char *filePath)
 {
@@ -10,6 +13,9 @@ dotBox2d::dotBox2d(const char *filePath)
 
 dotBox2d::~dotBox2d()
 {
+    if (this->p_db2IncrementalDecoder)
+        delete this->p_db2IncrementalDecoder;
+
     if (this->p_b2w)
         delete this->p_b2w;
 
@@ -49,13 +55,48 @@ auto dotBox2d::load(const char *filePath) -> void
     while (fs.peek() != EOF)
     {
         auto &chunk = this->chunks.emplace();
-        chunk.read(fs, isFileLittleEndian);
+        if (!chunk.read(fs, isFileLittleEndian))
+        {
+            this->chunks.pop_back(); // malformed or cut short, the chunks before are kept
+            break;
+        }
     };
 
     fs.close();
+
+    db2Dict::Upgrade(this->chunks, HardwareDifference::IsLittleEndian() != isFileLittleEndian); // dicts of dotBox2d 0.0.1
+}
+
+auto dotBox2d::parse(const char *bytes, const uint32_t length) -> void
+{
+    if (!bytes || length < sizeof(this->head))
+        return;
+
+    // read head
+    std::memcpy(this->head, bytes, sizeof(this->head));
+
+    // confirm endia
+    const bool isFileLittleEndian = (this->head[3] == 'd');
+
+    // change to local endian
+    this->head[3] = HardwareDifference::IsLittleEndian() ? 'd' : 'D';
+
+    // read chunks
+    auto cursor = bytes + sizeof(this->head);
+    while (cursor < bytes + length)
+    {
+        auto &chunk = this->chunks.emplace();
+        if (!chunk.read(cursor, bytes + length, isFileLittleEndian))
+        {
+            this->chunks.pop_back(); // malformed or overrunning the bytes, the chunks before are kept
+            break;
+        }
+    };
+
+    db2Dict::Upgrade(this->chunks, HardwareDifference::IsLittleEndian() != isFileLittleEndian); // dicts of dotBox2d 0.0.1
 }
 
-auto dotBox2d::save(const char *filePath, bool asLittleEndian) -> void
+auto dotBox2d::save(const char *filePath, bool asLittleEndian, bool sortDicts) -> void
 {
     this->set_file_path(filePath);
 
@@ -63,18 +104,72 @@ auto dotBox2d::save(const char *filePath, bool asLittleEndian) -> void
     if (!fs)
         return;
 
+    // canonical layouts: dicts moved to layouts sorted by (key, type), searchable by binary search after loading.
+    // dicts are sorted, and the layouts no dict uses are dropped, in a copy-on-write fork, so saving leaves the document as it is
+    db2Chunks fork{};
+    if (this->chunks.at<CKLayout>() != nullval)
+    {
+        fork.share(this->chunks);
+        auto &dicts = fork.at<CKDict>();
+        for (uint32_t d = 0; sortDicts && dicts != nullval && d < dicts.size(); ++d)
+            dicts[d].sort();
+        db2Compactor::CompactLayouts(fork);
+    }
+    auto &chunks = fork.size() > 0 ? fork : this->chunks;
+
     // write head
     fs.write((char *)this->head, 3);
     fs.write(asLittleEndian ? "d" : "D", 1);
     fs.write((char *)this->head + 4, 4);
 
     // write chunks
-    for (auto i = 0; i < this->chunks.size(); ++i)
-        this->chunks[i].write(fs, asLittleEndian);
+    for (uint32_t i = 0; i < chunks.size(); ++i)
+        chunks[i].write(fs, asLittleEndian);
 
     fs.close();
 }
 
+auto dotBox2d::fork(dotBox2d &variant) -> void
+{
+    std::memcpy(variant.head, this->head, sizeof(this->head));
+    variant.chunks.share(this->chunks);
+
+    variant.dt = this->dt;
+    variant.inv_dt = this->inv_dt;
+    variant.velocityIterations = this->velocityIterations;
+    variant.positionIterations = this->positionIterations;
+}
+
+auto dotBox2d::compact() -> void
+{
+    auto &dicts = this->chunks.at<CKDict>();
+    if (dicts == nullval)
+        return;
+
+    db2DynArray<uint32_t> roots{};
+    for (auto d = 0; d < dicts.size(); ++d)
+        if (dicts[d].find<CKWorld>(db2Key::Base) != nullval || dicts[d].find<CKInfo>(db2Key::Base) != nullval)
+            roots.push_back(d);
+
+    auto remap = db2Compactor::Compact(this->chunks, {roots.data, roots.size()});
+
+    // userData of Box2D objects holds the indices of their dicts
+    if (!this->p_b2w)
+        return;
+    auto &dict_remap = remap[db2Reflector::GetReflector<CKDict>()->id];
+    auto rewrite = [&](uintptr_t &pointer)
+    { pointer = pointer < dict_remap.size() ? dict_remap[pointer] : UINT32_MAX; };
+
+    for (auto p_b2b = this->p_b2w->GetBodyList(); p_b2b; p_b2b = p_b2b->GetNext())
+    {
+        rewrite(p_b2b->GetUserData().pointer);
+        for (auto p_b2f = p_b2b->GetFixtureList(); p_b2f; p_b2f = p_b2f->GetNext())
+            rewrite(p_b2f->GetUserData().pointer);
+    }
+    for (auto p_b2j = this->p_b2w->GetJointList(); p_b2j; p_b2j = p_b2j->GetNext())
+        rewrite(p_b2j->GetUserData().pointer);
+}
+
 auto dotBox2d::decode() -> void
 {
     db2Decoder::Decode(*this);
@@ -83,9 +178,42 @@ auto dotBox2d::decode() -> void
     this->p_b2w->SetContactListener(this->p_db2ContactListener);
 }
 
-auto dotBox2d::encode() -> void
+auto dotBox2d::decode(const uint32_t objects, const float32_t milliseconds) -> bool
+{
+    if (!this->p_db2IncrementalDecoder)
+    {
+        if (this->p_b2w)
+            return true;
+        this->p_db2IncrementalDecoder = new db2IncrementalDecoder{*this};
+    }
+
+    if (!this->p_db2IncrementalDecoder->step(objects, milliseconds))
+        return false;
+
+    delete this->p_db2IncrementalDecoder;
+    this->p_db2IncrementalDecoder = nullptr;
+
+    if (this->p_b2w)
+    {
+        db2Transcoder::Transcode(*this);
+        this->p_b2w->SetContactListener(this->p_db2ContactListener);
+    }
+    return true;
+}
+
+auto dotBox2d::encode(const bool withDerived) -> void
+{
+    db2Decoder::Encode(*this, withDerived);
+}
+
+auto dotBox2d::encode_frame(dotBox2d &frame, const bool quantized) -> void
+{
+    db2Frame::Encode(*this, frame.chunks, quantized);
+}
+
+auto dotBox2d::decode_frame(dotBox2d &frame) -> bool
 {
-    db2Decoder::Encode(*this);
+    return db2Frame::Decode(*this, frame.chunks);
 }
 
 auto dotBox2d::step() -> void
@@ -9,6 +9,8 @@
 #include "events/db2_contact_listener.h"
 #include "events/db2_offstep_listener.h"
 
+class db2IncrementalDecoder;
+
 // struct b2World_e
 // {
 //     b2World *world{nullptr};
@@ -45,6 +47,9 @@ public: // runtime
     db2ContactListener *p_db2ContactListener{nullptr};
     db2OffstepListener *p_db2OffstepListener{nullptr};
 
+    // decoding in progress, see decode(objects, milliseconds)
+    db2IncrementalDecoder *p_db2IncrementalDecoder{nullptr};
+
 public: // constructors
     dotBox2d(const char *filePath = nullptr);
     ~dotBox2d();
@@ -53,10 +58,16 @@ public: // lifecycle
     auto set_file_path(const char *&filePath) -> void;
 
     auto load(const char *filePath = nullptr) -> void;
-    auto save(const char *filePath = nullptr, bool asLittleEndian = false) -> void;
+    auto parse(const char *bytes, const uint32_t length) -> void; // load from memory, payloads aligned to DB2_CHUNK_ALIGNMENT borrow bytes until modified
+    auto save(const char *filePath = nullptr, bool asLittleEndian = false, bool sortDicts = false) -> void; // writes every chunk, only layouts no dict uses are dropped
+    auto fork(dotBox2d &variant) -> void; // variant shares chunks copy-on-write, and decodes its own world
+    auto compact() -> void;               // drop values unreachable from the world and info dicts, such as dicts of objects destroyed since encoding
 
     auto decode() -> void;
-    auto encode() -> void;
+    auto decode(const uint32_t objects, const float32_t milliseconds = 0.0f) -> bool; // decode in slices, true once decoded, the world could be stepped in between. 0 for no limit
+    auto encode(const bool withDerived = false) -> void; // with derived data, which decoding then reads instead of recomputing. a document with a world is updated in place, see compact
+    auto encode_frame(dotBox2d &frame, const bool quantized = false) -> void; // dynamic state of bodies only, see db2Frame
+    auto decode_frame(dotBox2d &frame) -> bool;                              // false if frame does not match the world
 
     auto step() -> void;
 
@@ -22,7 +22,7 @@
 //     // && std::same_as<std::invoke_result_t<Atom_Opr, T, Args...>, T>;
 
 template <typename T = float32_t>
-class db2Tensor : public db2DynArray<T>
+class db2Tensor : public db2DynArray<T, 2, DB2_TENSOR_ALIGNMENT> // scalars and vec2s stay inline
 {
 
 public: // static
@@ -93,7 +93,7 @@ public: // static
 
 public: // properties
     //
-    db2DynArray<uint32_t> shape; // shape of tensor
+    db2DynArray<uint32_t, 4> shape; // shape of tensor
 
     auto plain_size() const -> uint32_t
     {
@@ -128,19 +128,19 @@ public: // constructors
 
     // for scalar
     db2Tensor(const T scalar)
-        : db2DynArray<T>{scalar} {}
+        : db2DynArray<T, 2, DB2_TENSOR_ALIGNMENT>{scalar} {}
 
     // for vector
     db2Tensor(const std::initializer_list<T> &arg_list)
-        : db2DynArray<T>(arg_list), shape{static_cast<uint32_t>(arg_list.size())} {}
+        : db2DynArray<T, 2, DB2_TENSOR_ALIGNMENT>(arg_list), shape{static_cast<uint32_t>(arg_list.size())} {}
 
     db2Tensor(const std::initializer_list<T> &arg_list, const std::initializer_list<uint32_t> &shape_arg_list)
-        : db2DynArray<T>(arg_list), shape(shape_arg_list) {}
+        : db2DynArray<T, 2, DB2_TENSOR_ALIGNMENT>(arg_list), shape(shape_arg_list) {}
 
-    auto init(const db2DynArray<uint32_t> &shape, const uint32_t loose_plain_size = 0, bool initialize = true) -> void
+    auto init(const db2DynArray<uint32_t, 4> &shape, const uint32_t loose_plain_size = 0, bool initialize = true) -> void
     {
         this->shape = shape;
-        this->db2DynArray<T>::init(loose_plain_size == 0 ? this->plain_size() : loose_plain_size, initialize);
+        this->db2DynArray<T, 2, DB2_TENSOR_ALIGNMENT>::init(loose_plain_size == 0 ? this->plain_size() : loose_plain_size, initialize);
     }
 
     explicit operator bool() const
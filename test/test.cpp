@@ -1,4 +1,5 @@
 #include <cmath>
+#include <fstream>
 #include <iostream>
 #include <type_traits> // std::is_same
 
@@ -13,10 +14,13 @@
 #include "containers/db2_dynarray.h"
 #include "containers/db2_chunk.h"
 #include "containers/db2_cson.h"
+#include "containers/db2_compactor.h"
+#include "containers/db2_builder.h"
 
 // #include "script/db2_function.h"
 
 #include "data/db2_structure.h"
+#include "data/db2_views.h"
 
 #include "decoders/db2_decoder.h"
 
@@ -482,6 +486,7 @@ auto test_typeid() -> void
 
 auto test_inline_static() -> void
 {
+    db2Reflector::Register(); // built-in types are registered on first access
     printf("db2Reflector::reflectors.size(): %d\n", db2Reflector::reflectors.size());
     // if db2Reflector::reflectors is inline static, the size is zero;
     // else if db2Reflector::reflectors is not inline, the size is not zero.
@@ -490,6 +495,22 @@ auto test_inline_static() -> void
     // // output 1 rather than 2
 }
 
+auto test_reflector_clear() -> void
+{
+    db2Reflector::GetReflector<CKDict>(); // cached
+    db2Reflector::ClearReflectors();
+    printf("registered: %d, reflectors: %u\n", db2Reflector::registered, db2Reflector::reflectors.size()); // 0, 0
+
+    auto reflector = db2Reflector::GetReflector<CKDict>(); // registers the built-in types again
+    printf("registered: %d, %.4s, as by type: %d\n", db2Reflector::registered, reflector->type,
+           reflector == db2Reflector::GetReflector(db2ChunkType_CSON::DIcT)); // 1, DIcT, 1
+
+    dotBox2d db2{};
+    auto &dict = db2.chunks.get<CKDict>().emplace_back();
+    dict.emplace<int32_t>(1, 10);
+    printf("key 1 = %d\n", dict.at<int32_t>(1)); // 10
+}
+
 auto test_lambda() -> void
 {
     auto lambda = [](int a, int b) -> int
@@ -576,6 +597,19 @@ auto test_nullval() -> void
     // i = 1; // can't be avoided !!
 }
 
+auto test_dynarray_inline() -> void
+{
+    // elements holding their own inline data are moved, not copied bytewise, into the inline buffer
+    db2DynArray<db2DynArray<int32_t, 2>, 4> arrays{};
+    arrays.reserve(8); // on the heap
+    for (int32_t i = 0; i < 3; ++i)
+        arrays.emplace_back().push_back(i * 10);
+    arrays.shrink_to_fit();
+
+    printf("inline: %d, elements inline: %d %d %d, values: %d %d %d\n", arrays.is_inline(),
+           arrays[0].is_inline(), arrays[1].is_inline(), arrays[2].is_inline(), arrays[0][0], arrays[1][0], arrays[2][0]); // 1, 1 1 1, 0 10 20
+}
+
 auto test_data_structure_write() -> void
 {
     auto db2 = new dotBox2d();
@@ -597,16 +631,19 @@ auto test_data_structure_write() -> void
 
     if (true) // test for db2Dynarry::append
     {
-        auto &da = reinterpret_cast<db2DynArray<db2DictElement> &>(dict);
-        da.emplace_back(0, 'e', 'p', 'b', '0', 0); // good
+        db2DynArray<db2DictElement> da{};
+        da.emplace_back(0, 'e', 'p', 'b', '0'); // good
+
+        // // da.append(1, 'a', 'p', 'd', '1', 2, 'a', 'p', 'd', '2', 3); // compilable but ill
+        // da.append(db2DictElement{1, 'a', 'p', 'd', '1'}, db2DictElement{2, 'a', 'p', 'd', '2'});
 
-        // // da.append(1, 'a', 'p', 'd', '1', 1, 2, 'a', 'p', 'd', '2', 2, 3); // compilable but ill
-        // da.append(db2DictElement{1, 'a', 'p', 'd', '1', 1}, db2DictElement{2, 'a', 'p', 'd', '2', 2});
+        // da.append_range({1, 'a', 'p', 'r', '1'}, {2, 'a', 'p', 'r', '2'}, {3, 'a', 'p', 'r', '3'}); // not compilable
+        // da.append_range({'1', 'a', 'p', 'r', '1'}, {'2', 'a', 'p', 'r', '2'}); // (std::initializer_list<Args>... args_lists) // all args within {} need to be of a same type.
+        da.append_range({{1, 'a', 'p', 'r', '1'}, {2, 'a', 'p', 'r', '2'}}); // (std::initializer_list<U> arg_list)
+        // da.append_range({ std::make_tuple(1, 'a', 'p', 'r', '1'), {2, 'a', 'p', 'r', '2'} }); // (const std::initializer_list<std::tuple<Args...>> &arg_list)
 
-        // da.append_range({1, 'a', 'p', 'r', '1', 1}, {2, 'a', 'p', 'r', '2', 2}, {3, 'a', 'p', 'r', '3', 3}); // not compilable
-        // da.append_range({'1', 'a', 'p', 'r', '1', '1'}, {'2', 'a', 'p', 'r', '2', '2'}); // (std::initializer_list<Args>... args_lists) // all args within {} need to be of a same type.
-        da.append_range({{1, 'a', 'p', 'r', '1', 1}, {2, 'a', 'p', 'r', '2', 2}}); // (std::initializer_list<U> arg_list)
-        // da.append_range({ std::make_tuple(1, 'a', 'p', 'r', '1', 1), {2, 'a', 'p', 'r', '2', 2} }); // (const std::initializer_list<std::tuple<Args...>> &arg_list)
+        for (uint32_t e = 0; e < da.size(); ++e)
+            dict.append(da[e].key, e);
     }
 
     dict.get(1) = 2;
@@ -616,7 +653,7 @@ auto test_data_structure_write() -> void
     const auto &f = dict.at<float32_t>(2);
     const auto &null = dict.at<int32_t>(3);
 
-    auto &d = dict.find(*(int32_t *)nullptr, nullptr);
+    auto &d = dict.find(nullval, nullptr); // any key
     auto &d2 = dict.find(2);
 
     dict.link<db2Chunk<db2Shape>>(100) = 2;
@@ -652,6 +689,297 @@ auto test_data_structure_read() -> void
     return;
 }
 
+auto test_dict_lookup() -> void
+{
+    dotBox2d db2{};
+    auto &dict = db2.chunks.get<CKDict>().emplace_back();
+    for (int32_t k = 0; k < 64; ++k)
+        dict.emplace<int32_t>(k, k * 3);
+    dict.emplace<float32_t>(7, 0.5f); // same key, different type
+
+    int32_t mismatch = 0;
+    for (int32_t k = 0; k < 80; ++k)
+    {
+        auto &value = dict.find(k); // hashed, since size >= DB2_DICT_LOOKUP_THRESHOLD
+        auto index = dict.layout().find_index([&k](db2DictElement &e)
+                                              { return e.key == k; });
+        if (index == UINT32_MAX ? value != nullval : &value != &dict[index])
+            ++mismatch;
+    }
+
+    printf("key table built: %s\n", dict.layout().lookup ? "true" : "false"); // true
+    printf("mismatch: %d\n", mismatch);                                        // 0
+    printf("at<int32_t>(7) = %d\n", dict.at<int32_t>(7));              // 21
+    printf("at<float32_t>(7) = %f\n", dict.at<float32_t>(7));          // 0.500000
+    printf("at<int32_t>(100) is null: %d\n", dict.at<int32_t>(100) == nullval); // 1
+}
+
+auto test_dict_sorted() -> void
+{
+    {
+        dotBox2d db2{};
+        auto &dict = db2.chunks.get<CKDict>().emplace_back();
+        for (int32_t k = 16; k > 0; --k)
+            dict.emplace<int32_t>(k, k * 3);
+        dict.emplace<float32_t>(8, 0.5f);
+        auto &note = db2.chunks.at<CKDict>().emplace_back(); // of neither a world nor an info, could move dict
+        note.emplace<db2Chunk<db2String>>(2, "kept");
+        note.emplace<int32_t>(1, 7);
+        db2.save("./test_sorted.B2D", false, true);
+        auto &saved = db2.chunks.at<CKDict>()[0];
+        printf("saved as is: %d, %.4s\n", saved.element(0).key, saved.layout().type); // 16, LAYT
+        printf("layouts: %u\n", db2.chunks.at<CKLayout>().size());                  // 19, one for each prefix
+    }
+
+    dotBox2d db2{"./test_sorted.B2D"};
+    db2.load();
+    auto &dict = db2.chunks.at<CKDict>()[0];
+
+    printf("layouts saved: %u\n", db2.chunks.at<CKLayout>().size()); // 2, the sorted ones in use
+    printf("layout type: %.4s\n", dict.layout().type);          // LAYt
+    printf("first key: %d\n", dict.element(0).key);             // 1
+    printf("at<int32_t>(8) = %d\n", dict.at<int32_t>(8));       // 24
+    printf("at<float32_t>(8) = %f\n", dict.at<float32_t>(8));   // 0.500000
+    printf("key table built: %s\n", dict.layout().lookup ? "true" : "false"); // false, binary search instead
+
+    auto &note = db2.chunks.at<CKDict>()[1];
+    auto &text = note.at<db2Chunk<db2String>>(2);
+    printf("dicts saved: %u, note: %d, %.*s\n", db2.chunks.at<CKDict>().size(), note.at<int32_t>(1), int(text.size()), text.data); // 2, 7, kept
+}
+
+auto test_dict_layout() -> void
+{
+    dotBox2d db2{};
+    auto &dicts = db2.chunks.get<CKDict>();
+    for (int32_t i = 0; i < 3; ++i)
+    {
+        auto &dict = dicts.emplace_back();
+        dict.emplace<int32_t>(1, i);
+        dict.emplace<int32_t>(2, i * 10);
+        if (i == 2)
+            dict.emplace<float32_t>(3, 0.5f);
+    }
+
+    db2DictSlot slot{};
+    for (int32_t i = 0; i < 3; ++i)
+        printf("dicts[%d] key 2 = %d\n", i, dicts[i].find(2, nullptr, slot)); // 0, 10, 20
+
+    printf("shared layout: %d\n", dicts[0].layout_i() == dicts[1].layout_i()); // 1
+    printf("forked layout: %d\n", dicts[1].layout_i() != dicts[2].layout_i()); // 1
+    printf("layouts: %u\n", db2.chunks.at<CKLayout>().size());                 // 3, {1} {1 2} {1 2 3}
+    printf("bytes of dicts[2]: %u\n", dicts[2].length);                        // 12, values only
+}
+
+// a world of a dynamic body at (1, 2) with a circle of radius 0.5 and density 2, encoded and saved
+// big-endian by dotBox2d 0.0.1, whose dicts store 12-byte elements {key, type, value}
+static const unsigned char legacy_BE[]{
+    0xB2, 0x42, 0x32, 0x44, 0x0D, 0x0A, 0x1A, 0x0A, 0x00, 0x00, 0x00, 0x74, 0x44, 0x49, 0x63, 0x54,
+    0x00, 0x00, 0x00, 0x0C, 0x44, 0x49, 0x43, 0x54, 0x00, 0x00, 0x00, 0x02, 0x49, 0x4E, 0x46, 0x4F,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x18, 0x44, 0x49, 0x43, 0x54, 0x00, 0x00, 0x00, 0x02,
+    0x57, 0x52, 0x4C, 0x44, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x08, 0x20, 0x4C, 0x49, 0x73, 0x54,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x18, 0x44, 0x49, 0x43, 0x54, 0x00, 0x00, 0x00, 0x02,
+    0x42, 0x4F, 0x44, 0x59, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x08, 0x30, 0x4C, 0x49, 0x73, 0x54,
+    0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x18, 0x44, 0x49, 0x43, 0x54, 0x00, 0x00, 0x00, 0x02,
+    0x46, 0x58, 0x54, 0x52, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x08, 0x40, 0x53, 0x48, 0x70, 0x45,
+    0x00, 0x00, 0x00, 0x00, 0xB1, 0xCE, 0xE2, 0xE2, 0x00, 0x00, 0x00, 0x08, 0x49, 0x4E, 0x46, 0x4F,
+    0x08, 0x00, 0x00, 0x00, 0x01, 0x02, 0x04, 0x01, 0xBB, 0x18, 0x9F, 0xFA, 0x00, 0x00, 0x00, 0x14,
+    0x57, 0x52, 0x4C, 0x44, 0x00, 0x00, 0x00, 0x00, 0xC1, 0x1C, 0xCC, 0xCD, 0x42, 0x70, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x06, 0x00, 0x00, 0x00, 0x02, 0xC7, 0x48, 0xE5, 0x1F, 0x00, 0x00, 0x00, 0x18,
+    0x4C, 0x49, 0x73, 0x54, 0x00, 0x00, 0x00, 0x04, 0x44, 0x49, 0x63, 0x54, 0x00, 0x00, 0x00, 0x02,
+    0x00, 0x00, 0x00, 0x04, 0x44, 0x49, 0x63, 0x54, 0x00, 0x00, 0x00, 0x03, 0xB6, 0xAC, 0x70, 0x5F,
+    0x00, 0x00, 0x00, 0x30, 0x42, 0x4F, 0x44, 0x59, 0x00, 0x00, 0x00, 0x02, 0x3F, 0x80, 0x00, 0x00,
+    0x40, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x01, 0x00, 0x00,
+    0x01, 0x00, 0x00, 0x00, 0x3F, 0x80, 0x00, 0x00, 0xC1, 0x82, 0x94, 0x48, 0x00, 0x00, 0x00, 0x18,
+    0x46, 0x58, 0x54, 0x52, 0x3E, 0x4C, 0xCC, 0xCD, 0x00, 0x00, 0x00, 0x00, 0x3F, 0x80, 0x00, 0x00,
+    0x40, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0xFF, 0xFF, 0x00, 0x00, 0x55, 0x2D, 0x3B, 0x79,
+    0x00, 0x00, 0x00, 0x14, 0x53, 0x48, 0x70, 0x45, 0x00, 0x00, 0x00, 0x0C, 0x53, 0x48, 0x50, 0x00,
+    0x3F, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x05, 0xB2, 0x4C, 0xD2};
+
+auto test_dict_legacy() -> void
+{
+    dotBox2d db2{};
+    db2.parse((const char *)legacy_BE, sizeof(legacy_BE));
+    printf("layouts: %u\n", db2.chunks.at<CKLayout>().size()); // 4, of the info, world, body and fixture dicts
+    printf("world dict: %u\n", db2.world_dict_i());            // 1
+
+    db2.decode();
+    auto p_b2b = db2.p_b2w->GetBodyList();
+    auto p_b2f = p_b2b->GetFixtureList();
+    printf("body: (%g, %g), radius: %g, density: %g\n",
+           p_b2b->GetPosition().x, p_b2b->GetPosition().y, p_b2f->GetShape()->m_radius, p_b2f->GetDensity()); // (1, 2), 0.5, 2
+
+    // saved in the current format, and loaded as it is
+    db2.save("./test_legacy_BE.B2D", false);
+    dotBox2d again{"./test_legacy_BE.B2D"};
+    again.load();
+    again.decode();
+    p_b2b = again.p_b2w->GetBodyList();
+    printf("saved again: (%g, %g), dicts typed legacy: %d\n", p_b2b->GetPosition().x, p_b2b->GetPosition().y,
+           again.chunks.at<CKDict>()[0].layout_i() == db2Dict::Legacy); // (1, 2), 0
+}
+
+auto test_fork() -> void
+{
+    dotBox2d db2{};
+    auto &dict = db2.chunks.get<CKDict>().emplace_back();
+    dict.emplace<int32_t>(1, 10);
+    dict.emplace<db2Chunk<db2String>>(2, "original");
+
+    dotBox2d variant{};
+    db2.fork(variant);
+    variant.chunks.at<CKDict>()[0].link<int32_t>(1) = 20; // detaches the dict of variant only
+
+    printf("db2 key 1 = %d\n", db2.chunks.at<CKDict>()[0].at<int32_t>(1));         // 10
+    printf("variant key 1 = %d\n", variant.chunks.at<CKDict>()[0].at<int32_t>(1)); // 20
+    printf("string shared: %d\n", db2.chunks.at<CKString>()[0].data == variant.chunks.at<CKString>()[0].data); // 1
+}
+
+auto test_parse() -> void
+{
+    dotBox2d db2{};
+    auto &dict = db2.chunks.get<CKDict>().emplace_back();
+    dict.emplace<int32_t>(1, 10);
+    db2.save("parse.b2d", HardwareDifference::IsLittleEndian());
+
+    // the payload of the dict follows the head and two chunk headers, 24 bytes in, and is borrowed
+    // only if it is aligned as allocated payloads are
+    std::ifstream fs{"parse.b2d", std::ios::binary | std::ios::ate};
+    uint32_t length = fs.tellg();
+    db2DynArray<char, 0, DB2_CHUNK_ALIGNMENT> memory{};
+    memory.init(length + DB2_CHUNK_ALIGNMENT, false);
+    fs.seekg(0);
+    fs.read(memory.data + DB2_CHUNK_ALIGNMENT - 20, length);
+    {
+        dotBox2d misaligned{};
+        misaligned.parse(memory.data + DB2_CHUNK_ALIGNMENT - 20, length);
+        auto &dict_m = misaligned.chunks.at<CKDict>()[0];
+        printf("misaligned dict borrowed: %d, key 1 = %d\n", dict_m.is_view(), dict_m.at<int32_t>(1)); // 0, 10
+    }
+    auto bytes = memory.data + DB2_CHUNK_ALIGNMENT - 24;
+    std::memmove(bytes, memory.data + DB2_CHUNK_ALIGNMENT - 20, length);
+
+    dotBox2d parsed{};
+    parsed.parse(bytes, length);
+    auto &dict_p = parsed.chunks.at<CKDict>()[0];
+    printf("dict borrowed: %d, key 1 = %d\n", dict_p.is_view(), dict_p.at<int32_t>(1)); // 1, 10
+    dict_p.link<int32_t>(1) = 20;                                                       // promotes to an owned copy
+    printf("dict borrowed: %d, key 1 = %d\n", dict_p.is_view(), dict_p.at<int32_t>(1)); // 0, 20
+
+    dotBox2d written{};
+    written.parse(bytes, length);
+    written.chunks.at<CKDict>()[0].ref<int32_t>(1) = 30; // promotes too, bytes are not written
+    dotBox2d again{};
+    again.parse(bytes, length);
+    printf("bytes kept: key 1 = %d\n", again.chunks.at<CKDict>()[0].at<int32_t>(1)); // 10
+
+    dotBox2d cut{};
+    cut.parse(bytes, length - 1);
+    printf("chunks of cut bytes: %u\n", cut.chunks.size()); // 1, the overrunning LAyt is dropped
+}
+
+auto test_bind() -> void
+{
+    db2Chunks chunks{};
+    auto &dicts = chunks.get<CKDict>();
+    dicts.emplace_back();
+    for (int i = 0; i < 3; ++i)
+    {
+        dicts[0].get<CKList>(db2Key::BODY).emplace_back_ref<CKDict>(dicts.size());
+        dicts.emplace_back().emplace<CKBody>(db2Key::Base).angle = i * 0.5f;
+    }
+
+    auto &list = dicts[0].at<CKList>(db2Key::BODY);
+    auto body_dicts = list.bind<CKDict>();     // CKDict chunk resolved once
+    auto bodies = dicts[0].bind<CKBody>();     // CKBody chunk resolved once
+    for (int i = 0; i < list.size(); ++i)
+        printf("body %d angle = %f\n", i, bodies(body_dicts.at(i)).at(db2Key::Base).angle); // 0.0, 0.5, 1.0
+}
+
+auto test_schema() -> void
+{
+    db2Chunks chunks{};
+    auto &dicts = chunks.get<CKDict>();
+    for (int i = 0; i < 3; ++i)
+        dicts.emplace_back().emplace<CKBody>(db2Key::Base).angle = i * 0.5f;
+    dicts[2].get<CKList>(db2Key::FIXTURE);
+
+    db2BodyView body{};
+    for (int i = 0; i < dicts.size(); ++i)
+    {
+        auto valid = body.bind(dicts[i]); // dicts 0 and 1 share a layout, resolved once
+        printf("body %d valid = %d, angle = %f, fixtures = %d\n", i, valid, body.base().angle, body.fixtures() != nullval);
+    }
+}
+
+auto test_compact() -> void
+{
+    db2Chunks chunks{};
+    auto &dicts = chunks.get<CKDict>();
+    dicts.emplace_back();
+    for (int i = 0; i < 3; ++i)
+    {
+        dicts[0].get<CKList>(db2Key::BODY).emplace_back_ref<CKDict>(dicts.size());
+        dicts.emplace_back().emplace<CKBody>(db2Key::Base).angle = i * 0.5f;
+    }
+    dicts[0].at<CKList>(db2Key::BODY).erase(1); // body dict 2 is no longer reachable
+    dicts[0].emplace<int32_t>(1, 7);                                           // stored in place
+    chunks.emplace().pre_init(db2Reflector::GetReflector<int32_t>(), &chunks); // a PODI chunk, as read from a file
+
+    uint32_t root = 0;
+    db2Compactor::Compact(chunks, {&root, 1});
+    printf("dicts = %d, bodies = %d\n", chunks.at<CKDict>().size(), chunks.at<CKBody>().size()); // 3, 2
+    printf("angle = %f\n", chunks.at<CKDict>()[0].at<CKList>(db2Key::BODY).at<CKDict>(1).at<CKBody>(db2Key::Base).angle); // 1.0
+    printf("in place = %d\n", chunks.at<CKDict>()[0].at<int32_t>(1)); // 7
+}
+
+auto test_references() -> void
+{
+    db2Chunks chunks{};
+    auto &dicts = chunks.get<CKDict>();
+    dicts.emplace_back().emplace<CKBody>(db2Key::Base); // body dict 0
+    dicts.emplace_back().emplace<CKBody>(db2Key::Base); // body dict 1
+    auto &joint_body_list = dicts.emplace_back().get<CKList>(db2Key::BODY);
+    joint_body_list.emplace_back_ref<CKDict>(0);
+    joint_body_list.emplace_back_ref<CKDict>(1);
+
+    db2References references{};
+    references.build(chunks);
+    chunks.at<CKDict>().emplace_back().link<CKDict>(db2Key::JOINT, 1); // recorded on mutation
+
+    references.for_each<CKDict>(1, [](const db2Referrer &referrer)
+                                { printf("dict 1 is referred by %d[%d], key %d\n", referrer.id, referrer.index, referrer.key); });
+
+    {
+        db2Chunks scoped{};
+        scoped.get<CKDict>().emplace_back();
+        references.build(scoped);
+    } // scoped detaches the index when destroyed
+    printf("attached after scope: %d\n", references.chunks != nullptr);
+}
+
+auto test_builder() -> void
+{
+    db2Chunks chunks{};
+    db2Builder builder{chunks};
+
+    auto first_dict = builder.append<CKDict>(3);  // world dict, body dicts
+    auto first_body = builder.append<CKBody>(2);  // pool grows once
+    auto first_list = builder.append<CKList>(1);
+
+    auto &dicts = builder.pool<CKDict>();
+    auto &body_list = builder.pool<CKList>()[first_list];
+    db2Builder::Link<CKDict>(body_list, first_dict + 1, 2);
+    db2Builder::Link<CKList>(dicts[first_dict], db2Key::BODY, first_list);
+    for (uint32_t i = 0; i < 2; ++i)
+        db2Builder::Link<CKBody>(dicts[first_dict + 1 + i], db2Key::Base, first_body + i);
+    builder.finish();
+
+    auto &bodies = dicts[first_dict].at<CKList>(db2Key::BODY);
+    for (uint32_t i = 0; i < bodies.size(); ++i)
+        printf("body dict %d -> body %d\n", bodies[i], dicts[bodies[i]].ref<CKBody>(db2Key::Base));
+}
+
 auto test_step(dotBox2d &db2) -> void
 {
     auto dynamicBody = db2.p_b2w->GetBodyList()->GetNext();
@@ -734,6 +1062,703 @@ auto test_decoding() -> void
     test_step(db2);
 }
 
+auto test_decoding_bulk() -> void
+{
+    dotBox2d db2{};
+    db2.p_b2w = new b2World{{0.0f, -9.8f}};
+
+    b2CircleShape circle{};
+    circle.m_radius = 0.5f;
+    for (auto i = 0; i < 4 * DB2_DECODE_BATCH; ++i) // enough bodies for several decoding threads
+    {
+        b2BodyDef bodydef{};
+        bodydef.type = b2_dynamicBody;
+        bodydef.position.Set(float(i % 100), float(i / 100));
+        db2.p_b2w->CreateBody(&bodydef)->CreateFixture(&circle, 1.0f);
+    }
+    db2.encode();
+
+    dotBox2d variant{};
+    db2.fork(variant);
+    variant.decode();
+    printf("bodies: %d, decoded: %d\n", db2.p_b2w->GetBodyCount(), variant.p_b2w->GetBodyCount());
+}
+
+auto test_decoding_threads() -> void
+{
+    dotBox2d db2{};
+    db2.p_b2w = new b2World{{0.0f, -9.8f}};
+
+    b2CircleShape circle{};
+    b2PolygonShape box{};
+    for (auto i = 0; i < 2 * DB2_DECODE_BATCH + 64; ++i) // more than two batches, for several decoding threads
+    {
+        b2BodyDef bodydef{};
+        bodydef.type = i % 7 == 0 ? b2_staticBody : b2_dynamicBody;
+        bodydef.position.Set(float(i % 128), float(i / 128));
+        bodydef.angle = 0.01f * float(i % 100);
+        auto p_b2b = db2.p_b2w->CreateBody(&bodydef);
+        circle.m_radius = 0.25f + 0.01f * float(i % 16);
+        p_b2b->CreateFixture(&circle, 1.0f + float(i % 3));
+        if (i % 2 == 0)
+        {
+            box.SetAsBox(0.5f, 0.125f, {0.25f, 0.0f}, 0.1f * float(i % 5));
+            p_b2b->CreateFixture(&box, 2.0f);
+        }
+    }
+    db2.encode();
+
+    // built across threads by decode(), and in one thread by decode(0)
+    dotBox2d threaded{}, serial{};
+    db2.fork(threaded), db2.fork(serial);
+    threaded.decode();
+    serial.decode(0);
+
+    auto mismatches = 0;
+    auto p_b2b_s = serial.p_b2w->GetBodyList();
+    for (auto p_b2b = threaded.p_b2w->GetBodyList(); p_b2b && p_b2b_s; p_b2b = p_b2b->GetNext(), p_b2b_s = p_b2b_s->GetNext())
+    {
+        mismatches += p_b2b->GetUserData().pointer != p_b2b_s->GetUserData().pointer || p_b2b->GetType() != p_b2b_s->GetType() ||
+                      p_b2b->GetPosition() != p_b2b_s->GetPosition() || p_b2b->GetAngle() != p_b2b_s->GetAngle() ||
+                      p_b2b->GetMass() != p_b2b_s->GetMass() || p_b2b->GetInertia() != p_b2b_s->GetInertia() ||
+                      p_b2b->GetLocalCenter() != p_b2b_s->GetLocalCenter();
+
+        auto p_b2f_s = p_b2b_s->GetFixtureList();
+        for (auto p_b2f = p_b2b->GetFixtureList(); p_b2f || p_b2f_s; p_b2f = p_b2f->GetNext(), p_b2f_s = p_b2f_s->GetNext())
+        {
+            if (!p_b2f || !p_b2f_s)
+            {
+                ++mismatches;
+                break;
+            }
+            mismatches += p_b2f->GetUserData().pointer != p_b2f_s->GetUserData().pointer || p_b2f->GetType() != p_b2f_s->GetType() ||
+                          p_b2f->GetDensity() != p_b2f_s->GetDensity() || p_b2f->GetShape()->m_radius != p_b2f_s->GetShape()->m_radius;
+        }
+    }
+    printf("bodies: %d, %d, mismatches: %d\n", threaded.p_b2w->GetBodyCount(), serial.p_b2w->GetBodyCount(), mismatches); // 8256, 8256, 0
+}
+
+auto test_decoding_incremental() -> void
+{
+    dotBox2d db2{"./test_encode_BE.B2D"};
+    db2.load();
+
+    int t = 0;
+    while (!db2.decode(1)) // one body or joint per step
+    {
+        db2.step();
+        t++;
+    }
+    printf("decoded in %d steps, bodies: %d\n", t, db2.p_b2w->GetBodyCount());
+
+    dotBox2d whole{"./test_encode_BE.B2D"};
+    whole.load();
+    printf("decoded in one step without limits: %d\n", whole.decode(0)); // 0 for no count limit
+}
+
+auto test_decoding_gears() -> void
+{
+    dotBox2d db2{};
+    db2.p_b2w = new b2World{{0.0f, -9.8f}};
+    auto &b2w = *db2.p_b2w;
+
+    b2BodyDef bodydef{};
+    auto ground = b2w.CreateBody(&bodydef);
+    bodydef.type = b2_dynamicBody;
+    b2CircleShape circle{};
+    circle.m_radius = 0.5f;
+    auto wheel = b2w.CreateBody(&bodydef);
+    wheel->CreateFixture(&circle, 1.0f);
+    bodydef.position.Set(2.0f, 0.0f);
+    auto rack = b2w.CreateBody(&bodydef);
+    rack->CreateFixture(&circle, 1.0f);
+
+    b2RevoluteJointDef revolute{};
+    revolute.Initialize(ground, wheel, {0.0f, 0.0f});
+    auto p_revolute = b2w.CreateJoint(&revolute);
+    b2PrismaticJointDef prismatic{};
+    prismatic.Initialize(ground, rack, {2.0f, 0.0f}, {1.0f, 0.0f});
+    auto p_prismatic = b2w.CreateJoint(&prismatic);
+    b2GearJointDef gear{};
+    gear.bodyA = wheel, gear.bodyB = rack;
+    gear.joint1 = p_revolute, gear.joint2 = p_prismatic, gear.ratio = 2.0f;
+    b2w.CreateJoint(&gear);
+    db2.encode();
+
+    // the gear joint moved ahead of the joints it links, as another writer may list it
+    dotBox2d variant{};
+    db2.fork(variant);
+    db2WorldView world{};
+    world.bind(variant.world_dict());
+    auto &joints = world.joints();
+    auto last = joints[joints.size() - 1];
+    for (auto j = joints.size() - 1; j > 0; --j)
+        joints[j] = joints[j - 1];
+    joints[0] = last;
+
+    variant.decode();
+    auto gears = 0;
+    for (auto p_b2j = variant.p_b2w->GetJointList(); p_b2j; p_b2j = p_b2j->GetNext())
+        gears += p_b2j->GetType() == e_gearJoint;
+    printf("joints: %d, gears: %d\n", variant.p_b2w->GetJointCount(), gears); // 3, 1
+}
+
+auto test_decoding_mass() -> void
+{
+    dotBox2d db2{};
+    db2.p_b2w = new b2World{{0.0f, -9.8f}};
+
+    b2BodyDef bodydef{};
+    bodydef.type = b2_dynamicBody;
+    auto body = db2.p_b2w->CreateBody(&bodydef);
+
+    b2CircleShape circle{};
+    circle.m_radius = 0.25f;
+    for (auto i = 0; i < 64; ++i) // Box2D resets the mass data for each of them
+    {
+        circle.m_p.Set(0.5f * (i % 8), 0.5f * (i / 8));
+        body->CreateFixture(&circle, 1.0f + 0.1f * i);
+    }
+    db2.encode();
+
+    dotBox2d variant{};
+    db2.fork(variant);
+    variant.decode(); // the mass data is set once
+    auto decoded = variant.p_b2w->GetBodyList();
+    printf("mass: %f, %f; inertia: %f, %f\n", body->GetMass(), decoded->GetMass(), body->GetInertia(), decoded->GetInertia());
+
+    dotBox2d edges{};
+    edges.p_b2w = new b2World{{0.0f, -9.8f}};
+    auto edge_body = edges.p_b2w->CreateBody(&bodydef);
+    b2EdgeShape edge{};
+    edge.SetTwoSided({0.0f, 0.0f}, {1.0f, 0.0f});
+    edge_body->CreateFixture(&edge, 1.0f); // of density, but massless
+    edges.encode();
+
+    dotBox2d edges_variant{};
+    edges.fork(edges_variant);
+    edges_variant.decode();
+    b2MassData m0, m1;
+    edge_body->GetMassData(&m0);
+    edges_variant.p_b2w->GetBodyList()->GetMassData(&m1);
+    printf("massless: %f, %f; center: (%f, %f), (%f, %f); inertia: %f, %f\n",
+           m0.mass, m1.mass, m0.center.x, m0.center.y, m1.center.x, m1.center.y, m0.I, m1.I);
+}
+
+auto test_decoding_proxies() -> void
+{
+    dotBox2d db2{};
+    db2.p_b2w = new b2World{{0.0f, -9.8f}};
+
+    b2BodyDef bodydef{};
+    bodydef.type = b2_dynamicBody;
+    b2CircleShape circle{};
+    circle.m_radius = 0.25f;
+    for (auto i = 0; i < 4096; ++i)
+    {
+        bodydef.position.Set(float(i * 37 % 64), float(i * 11 % 64));
+        bodydef.enabled = i % 16 != 0;
+        db2.p_b2w->CreateBody(&bodydef)->CreateFixture(&circle, 1.0f);
+    }
+    db2.encode();
+
+    dotBox2d variant{}, incremental{};
+    db2.fork(variant), db2.fork(incremental);
+    variant.decode(); // proxies are inserted in spatial order
+    while (!incremental.decode(100)) // over the whole world, not only each slice
+        ;
+
+    auto enabled = 0;
+    for (auto body = variant.p_b2w->GetBodyList(); body; body = body->GetNext())
+        enabled += body->IsEnabled();
+    printf("proxies: %d, %d; enabled: %d\n", db2.p_b2w->GetProxyCount(), variant.p_b2w->GetProxyCount(), enabled);
+
+    // against the proxies of db2, inserted fixture by fixture in file order
+    printf("tree height: %d, decoded: %d, incremental: %d\n", db2.p_b2w->GetTreeHeight(), variant.p_b2w->GetTreeHeight(), incremental.p_b2w->GetTreeHeight()); // 13, 13, 13
+    printf("tree balance: %d, decoded: %d, incremental: %d\n", db2.p_b2w->GetTreeBalance(), variant.p_b2w->GetTreeBalance(), incremental.p_b2w->GetTreeBalance()); // 1, 1, 1
+    printf("tree quality: %.2f, decoded: %.2f, incremental: %.2f\n", db2.p_b2w->GetTreeQuality(), variant.p_b2w->GetTreeQuality(), incremental.p_b2w->GetTreeQuality()); // 106.17, 100.03, 100.03, lower is tighter
+}
+
+auto test_decoding_derived() -> void
+{
+    dotBox2d db2{};
+    db2.p_b2w = new b2World{{0.0f, -9.8f}};
+
+    b2BodyDef bodydef{};
+    bodydef.type = b2_dynamicBody;
+    b2PolygonShape polygon{};
+    polygon.SetAsBox(0.5f, 0.25f);
+    for (auto i = 0; i < 1024; ++i)
+    {
+        bodydef.position.Set(float(i % 32), float(i / 32));
+        db2.p_b2w->CreateBody(&bodydef)->CreateFixture(&polygon, 1.0f);
+    }
+    db2.encode(true); // with centroids, normals and mass of fixtures
+
+    dotBox2d variant{};
+    db2.fork(variant);
+    variant.decode(); // polygons are not set again
+    printf("mass: %f, %f\n", db2.p_b2w->GetBodyList()->GetMass(), variant.p_b2w->GetBodyList()->GetMass());
+}
+
+template <typename Codec> // values differing between two objects, by the getters of the codec
+auto codec_mismatches(typename Codec::object_type &a, typename Codec::object_type &b) -> uint32_t
+{
+    float32_t values_a[Codec::count + 1], values_b[Codec::count + 1];
+    Codec::Encode(a, values_a);
+    Codec::Encode(b, values_b);
+
+    uint32_t mismatches = 0;
+    for (uint32_t i = 0; i < Codec::count; ++i)
+        mismatches += std::fabs(values_a[i] - values_b[i]) > 1e-5f;
+    return mismatches;
+}
+
+auto test_encoding_roundtrip() -> void
+{
+    dotBox2d db2{};
+    db2.p_b2w = new b2World{{0.0f, -9.8f}};
+    auto &b2w = *db2.p_b2w;
+
+    /*shapes*/ // one of each type, a body each
+    b2BodyDef bodydef{};
+    auto ground = b2w.CreateBody(&bodydef);
+    b2EdgeShape edge{};
+    edge.SetOneSided({-2.0f, 0.0f}, {-1.0f, 0.0f}, {1.0f, 0.0f}, {2.0f, 0.0f});
+    ground->CreateFixture(&edge, 0.0f);
+
+    auto loop = b2w.CreateBody(&bodydef);
+    b2Vec2 vertices[4]{{-4.0f, -4.0f}, {4.0f, -4.0f}, {4.0f, 4.0f}, {-4.0f, 4.0f}};
+    b2ChainShape chain{};
+    chain.CreateLoop(vertices, 4);
+    loop->CreateFixture(&chain, 0.0f);
+
+    bodydef.type = b2_dynamicBody;
+    bodydef.position.Set(-1.0f, 2.0f);
+    auto body_a = b2w.CreateBody(&bodydef);
+    b2CircleShape circle{};
+    circle.m_radius = 0.5f;
+    circle.m_p.Set(0.25f, -0.25f);
+    body_a->CreateFixture(&circle, 1.0f);
+
+    bodydef.position.Set(1.0f, 2.0f);
+    auto body_b = b2w.CreateBody(&bodydef);
+    b2PolygonShape polygon{};
+    polygon.SetAsBox(0.5f, 0.25f);
+    body_b->CreateFixture(&polygon, 2.0f);
+
+    /*joints*/ // one of each type, with values other than the defaults
+    b2RevoluteJointDef revolute{};
+    revolute.Initialize(ground, body_a, {-1.0f, 1.0f});
+    revolute.enableLimit = true, revolute.lowerAngle = -0.5f, revolute.upperAngle = 0.75f;
+    revolute.enableMotor = true, revolute.motorSpeed = 2.0f, revolute.maxMotorTorque = 10.0f;
+    auto p_revolute = b2w.CreateJoint(&revolute);
+
+    b2PrismaticJointDef prismatic{};
+    prismatic.Initialize(ground, body_b, {1.0f, 1.0f}, {0.0f, 1.0f});
+    prismatic.enableLimit = true, prismatic.lowerTranslation = -1.0f, prismatic.upperTranslation = 1.5f;
+    prismatic.enableMotor = true, prismatic.motorSpeed = -1.0f, prismatic.maxMotorForce = 20.0f;
+    auto p_prismatic = b2w.CreateJoint(&prismatic);
+
+    b2GearJointDef gear{};
+    gear.bodyA = body_a, gear.bodyB = body_b;
+    gear.joint1 = p_revolute, gear.joint2 = p_prismatic, gear.ratio = 3.0f;
+    b2w.CreateJoint(&gear);
+
+    b2DistanceJointDef distance{};
+    distance.Initialize(body_a, body_b, {-1.0f, 2.0f}, {1.0f, 2.5f});
+    distance.minLength = 1.0f, distance.maxLength = 3.0f, distance.stiffness = 5.0f, distance.damping = 0.5f;
+    b2w.CreateJoint(&distance);
+
+    b2PulleyJointDef pulley{};
+    pulley.Initialize(body_a, body_b, {-1.0f, 5.0f}, {1.0f, 5.0f}, {-1.0f, 2.0f}, {1.0f, 2.0f}, 1.5f);
+    b2w.CreateJoint(&pulley);
+
+    b2MouseJointDef mouse{};
+    mouse.bodyA = ground, mouse.bodyB = body_a;
+    mouse.target.Set(-1.0f, 2.5f), mouse.maxForce = 100.0f, mouse.stiffness = 8.0f, mouse.damping = 0.7f;
+    b2w.CreateJoint(&mouse);
+
+    b2WheelJointDef wheel{};
+    wheel.Initialize(body_a, body_b, {1.0f, 2.0f}, {0.0f, 1.0f});
+    wheel.enableLimit = true, wheel.lowerTranslation = -0.25f, wheel.upperTranslation = 0.25f;
+    wheel.enableMotor = true, wheel.motorSpeed = 4.0f, wheel.maxMotorTorque = 15.0f, wheel.stiffness = 6.0f, wheel.damping = 0.3f;
+    b2w.CreateJoint(&wheel);
+
+    b2WeldJointDef weld{};
+    weld.Initialize(body_a, body_b, {0.0f, 2.0f});
+    weld.stiffness = 7.0f, weld.damping = 0.2f;
+    b2w.CreateJoint(&weld);
+
+    b2FrictionJointDef friction{};
+    friction.Initialize(body_a, body_b, {0.0f, 2.0f});
+    friction.maxForce = 3.0f, friction.maxTorque = 4.0f;
+    b2w.CreateJoint(&friction);
+
+    b2MotorJointDef motor{};
+    motor.Initialize(body_a, body_b);
+    motor.maxForce = 5.0f, motor.maxTorque = 6.0f, motor.correctionFactor = 0.4f;
+    motor.collideConnected = true;
+    b2w.CreateJoint(&motor);
+
+    db2.encode();
+    dotBox2d variant{};
+    db2.fork(variant);
+    variant.decode();
+
+    /*compare*/ // objects are matched by their dicts, which both keep as userData
+    auto find_body = [&](b2Body *p_b2b) -> b2Body *
+    {
+        for (auto p = variant.p_b2w->GetBodyList(); p; p = p->GetNext())
+            if (p->GetUserData().pointer == p_b2b->GetUserData().pointer)
+                return p;
+        return nullptr;
+    };
+    auto find_joint = [&](b2Joint *p_b2j) -> b2Joint *
+    {
+        for (auto p = variant.p_b2w->GetJointList(); p; p = p->GetNext())
+            if (p->GetUserData().pointer == p_b2j->GetUserData().pointer)
+                return p;
+        return nullptr;
+    };
+
+    uint32_t shapes = 0, shape_mismatches = 0;
+    for (auto p_b2b = b2w.GetBodyList(); p_b2b; p_b2b = p_b2b->GetNext())
+    {
+        auto p_decoded = find_body(p_b2b);
+        auto &a = *p_b2b->GetFixtureList()->GetShape();
+        auto &b = *p_decoded->GetFixtureList()->GetShape();
+        ++shapes;
+        if (a.GetType() != b.GetType() || a.m_radius != b.m_radius)
+        {
+            ++shape_mismatches;
+            continue;
+        }
+
+        switch (a.GetType())
+        {
+        case b2Shape::e_circle:
+            shape_mismatches += codec_mismatches<db2CircleShapeCodec>((b2CircleShape &)a, (b2CircleShape &)b);
+            break;
+        case b2Shape::e_edge:
+            shape_mismatches += codec_mismatches<db2EdgeShapeCodec>((b2EdgeShape &)a, (b2EdgeShape &)b);
+            break;
+        case b2Shape::e_polygon:
+        {
+            auto &pa = (b2PolygonShape &)a, &pb = (b2PolygonShape &)b;
+            shape_mismatches += pa.m_count != pb.m_count || pa.m_centroid != pb.m_centroid;
+            for (auto v = 0; v < pa.m_count && pa.m_count == pb.m_count; ++v)
+                shape_mismatches += pa.m_vertices[v] != pb.m_vertices[v] || pa.m_normals[v] != pb.m_normals[v];
+            break;
+        }
+        case b2Shape::e_chain:
+        {
+            auto &ca = (b2ChainShape &)a, &cb = (b2ChainShape &)b;
+            shape_mismatches += ca.m_count != cb.m_count || ca.m_prevVertex != cb.m_prevVertex || ca.m_nextVertex != cb.m_nextVertex;
+            for (auto v = 0; v < ca.m_count && ca.m_count == cb.m_count; ++v)
+                shape_mismatches += ca.m_vertices[v] != cb.m_vertices[v];
+            break;
+        }
+        default:
+            break;
+        }
+    }
+
+    uint32_t joints = 0, joint_mismatches = 0;
+    for (auto p_b2j = b2w.GetJointList(); p_b2j; p_b2j = p_b2j->GetNext())
+    {
+        auto p_decoded = find_joint(p_b2j);
+        auto &a = *p_b2j;
+        auto &b = *p_decoded;
+        ++joints;
+        if (a.GetType() != b.GetType() || a.GetCollideConnected() != b.GetCollideConnected() ||
+            find_body(a.GetBodyA()) != b.GetBodyA() || find_body(a.GetBodyB()) != b.GetBodyB())
+        {
+            ++joint_mismatches;
+            continue;
+        }
+
+        switch (a.GetType())
+        {
+        case e_revoluteJoint:
+            joint_mismatches += codec_mismatches<db2RevoluteJointCodec>((b2RevoluteJoint &)a, (b2RevoluteJoint &)b);
+            break;
+        case e_prismaticJoint:
+            joint_mismatches += codec_mismatches<db2PrismaticJointCodec>((b2PrismaticJoint &)a, (b2PrismaticJoint &)b);
+            break;
+        case e_distanceJoint:
+            joint_mismatches += codec_mismatches<db2DistanceJointCodec>((b2DistanceJoint &)a, (b2DistanceJoint &)b);
+            break;
+        case e_pulleyJoint:
+            joint_mismatches += codec_mismatches<db2PulleyJointCodec>((b2PulleyJoint &)a, (b2PulleyJoint &)b);
+            break;
+        case e_mouseJoint:
+            joint_mismatches += codec_mismatches<db2MouseJointCodec>((b2MouseJoint &)a, (b2MouseJoint &)b);
+            break;
+        case e_gearJoint:
+            joint_mismatches += codec_mismatches<db2GearJointCodec>((b2GearJoint &)a, (b2GearJoint &)b);
+            joint_mismatches += find_joint(((b2GearJoint &)a).GetJoint1()) != ((b2GearJoint &)b).GetJoint1() ||
+                                find_joint(((b2GearJoint &)a).GetJoint2()) != ((b2GearJoint &)b).GetJoint2();
+            break;
+        case e_wheelJoint:
+            joint_mismatches += codec_mismatches<db2WheelJointCodec>((b2WheelJoint &)a, (b2WheelJoint &)b);
+            break;
+        case e_weldJoint:
+            joint_mismatches += codec_mismatches<db2WeldJointCodec>((b2WeldJoint &)a, (b2WeldJoint &)b);
+            break;
+        case e_frictionJoint:
+            joint_mismatches += codec_mismatches<db2FrictionJointCodec>((b2FrictionJoint &)a, (b2FrictionJoint &)b);
+            break;
+        case e_motorJoint:
+            joint_mismatches += codec_mismatches<db2MotorJointCodec>((b2MotorJoint &)a, (b2MotorJoint &)b);
+            break;
+        default:
+            break;
+        }
+    }
+    printf("shapes: %d, mismatches: %d; joints: %d, mismatches: %d\n", shapes, shape_mismatches, joints, joint_mismatches);
+}
+
+auto read_bytes(const char *filePath) -> std::string // empty if missing
+{
+    std::ifstream fs{filePath, std::ios::binary};
+    return std::string{std::istreambuf_iterator<char>{fs}, std::istreambuf_iterator<char>{}};
+}
+
+auto test_encoding_scene() -> void
+{
+    dotBox2d db2{};
+    db2.p_b2w = new b2World{{0.0f, -9.8f}};
+    auto &b2w = *db2.p_b2w;
+
+    /*ground*/ // of several fixtures
+    b2BodyDef bodydef{};
+    auto ground = b2w.CreateBody(&bodydef);
+    b2EdgeShape edge{};
+    edge.SetTwoSided({-8.0f, 0.0f}, {8.0f, 0.0f});
+    ground->CreateFixture(&edge, 0.0f);
+    b2PolygonShape box{};
+    box.SetAsBox(0.5f, 2.0f, {-8.0f, 2.0f}, 0.0f);
+    ground->CreateFixture(&box, 0.0f);
+    box.SetAsBox(0.5f, 2.0f, {8.0f, 2.0f}, 0.0f);
+    ground->CreateFixture(&box, 0.0f);
+
+    /*gears*/ // a wheel and a rack, each of several fixtures, linked by gear joints
+    bodydef.type = b2_dynamicBody;
+    b2CircleShape circle{};
+    b2Joint *p_revolutes[2], *p_prismatics[2];
+    for (auto i = 0; i < 2; ++i)
+    {
+        auto x = i == 0 ? -3.0f : 3.0f;
+        bodydef.position.Set(x, 4.0f);
+        auto wheel = b2w.CreateBody(&bodydef);
+        circle.m_radius = 1.0f;
+        circle.m_p.SetZero();
+        wheel->CreateFixture(&circle, 1.0f);
+        circle.m_radius = 0.25f;
+        circle.m_p.Set(0.75f, 0.0f);
+        wheel->CreateFixture(&circle, 2.0f);
+
+        bodydef.position.Set(x, 2.5f);
+        auto rack = b2w.CreateBody(&bodydef);
+        box.SetAsBox(1.5f, 0.25f);
+        rack->CreateFixture(&box, 1.0f);
+        box.SetAsBox(0.25f, 0.25f, {1.5f, 0.25f}, 0.0f);
+        rack->CreateFixture(&box, 1.0f);
+
+        b2RevoluteJointDef revolute{};
+        revolute.bodyA = ground, revolute.bodyB = wheel;
+        revolute.localAnchorA.Set(x, 4.0f);
+        p_revolutes[i] = b2w.CreateJoint(&revolute);
+
+        b2PrismaticJointDef prismatic{};
+        prismatic.bodyA = ground, prismatic.bodyB = rack;
+        prismatic.localAnchorA.Set(x, 2.5f);
+        prismatic.enableLimit = true, prismatic.lowerTranslation = -2.0f, prismatic.upperTranslation = 2.0f;
+        p_prismatics[i] = b2w.CreateJoint(&prismatic);
+
+        b2GearJointDef gear{};
+        gear.bodyA = wheel, gear.bodyB = rack;
+        gear.joint1 = p_revolutes[i], gear.joint2 = p_prismatics[i], gear.ratio = 1.0f;
+        b2w.CreateJoint(&gear);
+    }
+    b2GearJointDef gear{}; // between the wheels
+    gear.bodyA = p_revolutes[0]->GetBodyB(), gear.bodyB = p_revolutes[1]->GetBodyB();
+    gear.joint1 = p_revolutes[0], gear.joint2 = p_revolutes[1], gear.ratio = -1.0f;
+    b2w.CreateJoint(&gear);
+
+    db2.encode();
+    db2.save("./test_scene_BE.B2D", false);
+    auto bytes = read_bytes("./test_scene_BE.B2D");
+
+    // the reference is recorded by the first run, and later runs are compared against it
+    auto reference = read_bytes("./test_scene_ref_BE.B2D");
+    if (reference.empty())
+    {
+        std::ofstream{"./test_scene_ref_BE.B2D", std::ios::binary} << bytes;
+        reference = bytes;
+        printf("reference recorded\n");
+    }
+
+    // loaded, decoded and encoded again in place, the scene is saved to the same bytes
+    dotBox2d loaded{"./test_scene_BE.B2D"};
+    loaded.load();
+    loaded.decode();
+    loaded.encode();
+    loaded.save("./test_scene_again_BE.B2D", false);
+
+    printf("scene: %zu bytes, as the reference: %d, as encoded again: %d\n",
+           bytes.size(), bytes == reference, bytes == read_bytes("./test_scene_again_BE.B2D"));
+}
+
+auto test_encoding_inplace() -> void
+{
+    dotBox2d db2{};
+    db2.p_b2w = new b2World{{0.0f, -9.8f}};
+
+    b2BodyDef bodydef{};
+    bodydef.type = b2_dynamicBody;
+    b2CircleShape circle{};
+    circle.m_radius = 0.5f;
+    for (auto i = 0; i < 64; ++i)
+    {
+        bodydef.position.Set(float(i % 8), float(i / 8));
+        db2.p_b2w->CreateBody(&bodydef)->CreateFixture(&circle, 1.0f);
+    }
+    db2.encode();
+    auto dicts = db2.chunks.at<CKDict>().size();
+
+    db2.step();
+    db2.encode(); // bodies are overwritten, nothing is appended
+    printf("dicts: %u, %u\n", dicts, db2.chunks.at<CKDict>().size());
+
+    db2.p_b2w->DestroyBody(db2.p_b2w->GetBodyList());
+    db2.p_b2w->CreateBody(&bodydef)->CreateFixture(&circle, 1.0f);
+    db2.encode(); // the destroyed body is unlisted, the new one appended
+
+    // values of mapped objects are saved, and fixtures are encoded again once added or destroyed
+    auto moved = db2.p_b2w->GetBodyList()->GetNext();
+    moved->SetTransform({20.0f, 30.0f}, 0.5f);
+    auto refitted = moved->GetNext();
+    refitted->DestroyFixture(refitted->GetFixtureList());
+    refitted->CreateFixture(&circle, 2.0f);
+    refitted->CreateFixture(&circle, 3.0f);
+    b2MotorJointDef motordef{};
+    motordef.Initialize(moved, refitted);
+    auto motor = (b2MotorJoint *)db2.p_b2w->CreateJoint(&motordef);
+    db2.encode();
+    motor->SetMaxForce(9.0f);
+    db2.encode();
+
+    dotBox2d variant{};
+    db2.fork(variant);
+    variant.decode();
+    printf("bodies: %d, %d\n", db2.p_b2w->GetBodyCount(), variant.p_b2w->GetBodyCount());
+
+    auto find_body = [&](b2Body *p_b2b) -> b2Body *
+    {
+        for (auto p = variant.p_b2w->GetBodyList(); p; p = p->GetNext())
+            if (p->GetUserData().pointer == p_b2b->GetUserData().pointer)
+                return p;
+        return nullptr;
+    };
+    auto decoded = find_body(moved);
+    printf("moved: (%f, %f), (%f, %f)\n", moved->GetPosition().x, moved->GetPosition().y, decoded->GetPosition().x, decoded->GetPosition().y);
+    printf("fixtures: %d, density %f\n", db2Decoder::Count(find_body(refitted)->GetFixtureList()), find_body(refitted)->GetFixtureList()->GetDensity());
+    printf("motor max force: %f\n", ((b2MotorJoint *)variant.p_b2w->GetJointList())->GetMaxForce());
+
+    // destroyed objects leave dicts behind, which are only dropped by compact()
+    auto before = db2.chunks.at<CKDict>().size();
+    db2.p_b2w->DestroyJoint(motor);
+    for (auto i = 0; i < 48; ++i)
+        db2.p_b2w->DestroyBody(db2.p_b2w->GetBodyList());
+    db2.encode();
+    auto encoded = db2.chunks.at<CKDict>().size();
+    db2.compact();
+    printf("dicts: %u, %u, %u, bodies: %d\n", before, encoded, db2.chunks.at<CKDict>().size(), db2.p_b2w->GetBodyCount());
+
+    dotBox2d compacted{};
+    db2.fork(compacted);
+    compacted.decode();
+    printf("decoded bodies: %d\n", compacted.p_b2w->GetBodyCount());
+}
+
+auto test_encoding_reuse() -> void
+{
+    dotBox2d db2{};
+    db2.p_b2w = new b2World{{0.0f, -9.8f}};
+
+    b2BodyDef bodydef{};
+    bodydef.type = b2_dynamicBody;
+    b2CircleShape circle{};
+    circle.m_radius = 0.5f;
+    for (auto i = 0; i < 4; ++i)
+    {
+        bodydef.position.Set(float(i), 0.0f);
+        db2.p_b2w->CreateBody(&bodydef)->CreateFixture(&circle, 1.0f);
+    }
+    db2.encode();
+
+    // a new body, of userData 0, likely at the address of the destroyed one, whose dict still points to it
+    auto destroyed = db2.p_b2w->GetBodyList();
+    db2.p_b2w->DestroyBody(destroyed);
+    bodydef.position.Set(10.0f, 5.0f);
+    auto created = db2.p_b2w->CreateBody(&bodydef);
+    created->CreateFixture(&circle, 2.0f);
+    db2.encode(); // appended as a new body, not mapped to the dict of the destroyed one
+
+    dotBox2d variant{};
+    db2.fork(variant);
+    variant.decode();
+    auto found = 0;
+    for (auto p_b2b = variant.p_b2w->GetBodyList(); p_b2b; p_b2b = p_b2b->GetNext())
+        found += p_b2b->GetPosition() == b2Vec2{10.0f, 5.0f} && p_b2b->GetFixtureList()->GetDensity() == 2.0f;
+    printf("bodies: %d, %d, created found: %d\n", db2.p_b2w->GetBodyCount(), variant.p_b2w->GetBodyCount(), found); // 4, 4, 1
+}
+
+auto test_encoding_frame() -> void
+{
+    dotBox2d db2{};
+    db2.p_b2w = new b2World{{0.0f, -9.8f}};
+
+    b2BodyDef bodydef{};
+    b2EdgeShape ground{};
+    ground.SetTwoSided({-8.0f, -1.0f}, {16.0f, -1.0f});
+    db2.p_b2w->CreateBody(&bodydef)->CreateFixture(&ground, 0.0f); // static, without a state
+
+    bodydef.type = b2_dynamicBody;
+    b2CircleShape circle{};
+    circle.m_radius = 0.5f;
+    for (auto i = 0; i < 64; ++i)
+    {
+        bodydef.position.Set(float(i % 8), float(i / 8));
+        db2.p_b2w->CreateBody(&bodydef)->CreateFixture(&circle, 1.0f);
+    }
+    db2.encode();
+
+    dotBox2d replay{};
+    db2.fork(replay);
+    replay.decode();
+
+    dotBox2d other{}; // as many bodies, but one of them is not of the document
+    db2.fork(other);
+    other.decode();
+    other.p_b2w->DestroyBody(other.p_b2w->GetBodyList());
+    other.p_b2w->CreateBody(&bodydef)->CreateFixture(&circle, 1.0f);
+
+    for (auto i = 0; i < 60; ++i)
+        db2.step();
+    auto spun = db2.p_b2w->GetBodyList(); // more than a turn, which is not wrapped
+    spun->SetTransform(spun->GetPosition(), -7.5f);
+
+    dotBox2d frame{};
+    db2.encode_frame(frame, true); // 20 bytes a body
+    auto applied = replay.decode_frame(frame);
+    printf("applied: %d, y: %f, %f\n", applied, db2.p_b2w->GetBodyList()->GetPosition().y, replay.p_b2w->GetBodyList()->GetPosition().y);
+    printf("angle: %.3f, %.3f\n", spun->GetAngle(), replay.p_b2w->GetBodyList()->GetAngle()); // -7.500, -7.500
+    printf("states: %u, applied to another world: %d\n", frame.chunks.at<CKStateQ>().size(), other.decode_frame(frame));
+}
+
 auto main() -> int
 {
     // test_size();
@@ -754,6 +1779,7 @@ auto main() -> int
     // test_typeid();
 
     // test_inline_static();
+    // test_reflector_clear();
 
     /* ================================ */
 
@@ -762,10 +1788,35 @@ auto main() -> int
     // test_hardware_difference();
 
     // test_nullval();
+    // test_dynarray_inline();
 
     // test_data_structure_write();
     // test_data_structure_read();
 
+    // test_dict_lookup();
+    // test_dict_sorted();
+    // test_dict_layout();
+    // test_dict_legacy();
+    // test_fork();
+    // test_parse();
+    // test_bind();
+    // test_schema();
+    // test_compact();
+    // test_references();
+    // test_builder();
+    // test_decoding_bulk();
+    // test_decoding_threads();
+    // test_decoding_incremental();
+    // test_decoding_gears();
+    // test_decoding_mass();
+    // test_decoding_proxies();
+    // test_decoding_derived();
+    // test_encoding_roundtrip();
+    // test_encoding_scene();
+    // test_encoding_inplace();
+    // test_encoding_reuse();
+    // test_encoding_frame();
+
     test_encoding();
     test_decoding();
 